@@ -18,12 +18,19 @@
 
 #include "browser.h"
 
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <avahi-common/error.h>
 
 #include <cstdio>
 #include <algorithm>
-#include <stdexcept>
-#include <string>
+#include <functional>
+#include <iterator>
 
 namespace avahi {
 
@@ -34,6 +41,37 @@ struct Browser::Service {
     uint16_t port = 0;
     QStringList txt;
 
+    // Cast TXT record keys
+    QString device_id;        // id
+    QString friendly_name;    // fn
+    QString model;            // md
+    int capabilities = 0;     // ca
+    QString receiver_status;  // rs
+
+    void setTxt(AvahiStringList *txt);
+
+    // Where the service was found, for resolving it
+    QByteArray lookup_name;
+    QByteArray type;
+    QByteArray domain;
+    AvahiIfIndex iface = AVAHI_IF_UNSPEC;
+    AvahiProtocol protocol = AVAHI_PROTO_UNSPEC;
+    // When the service was last resolved, or -1
+    qint64 resolved_at = -1;
+    bool resolve_queued = false;
+    // The last resolve failed, so it is retried on the next expiry
+    // check
+    bool resolve_failed = false;
+
+    // Loaded from the cache, or failed to resolve, and not resolved
+    // since
+    bool stale = false;
+    // Reported by the browser since browsing started
+    bool seen = false;
+
+    void save(QDataStream& out) const;
+    void load(QDataStream& in);
+
     std::unique_ptr<AvahiSServiceResolver, decltype(&avahi_s_service_resolver_free)> resolver
         {nullptr, avahi_s_service_resolver_free};
 
@@ -42,63 +80,160 @@ struct Browser::Service {
         return service_name < other.service_name; }
 };
 
+namespace {
+
+// Whether a TXT entry has the given key.  Keys are ASCII and compared
+// case insensitively (RFC 6763 section 6.4).
+bool hasKey(const uint8_t *text, size_t size, const char (&key)[3]) {
+    return size >= 3 && text[2] == '=' &&
+        (text[0] | 0x20) == key[0] && (text[1] | 0x20) == key[1];
+}
+
+QString txtValue(const uint8_t *text, size_t size) {
+    return QString::fromUtf8(reinterpret_cast<const char*>(text) + 3,
+                             size - 3);
+}
+
+}
+
+void Browser::Service::setTxt(AvahiStringList *list) {
+    txt.clear();
+    device_id.clear();
+    friendly_name.clear();
+    model.clear();
+    capabilities = 0;
+    receiver_status.clear();
+    for (auto item = list; item != nullptr; item = avahi_string_list_get_next(item)) {
+        const uint8_t *text = avahi_string_list_get_text(item);
+        const size_t size = avahi_string_list_get_size(item);
+        // TXT values are opaque bytes, but Cast devices send UTF-8
+        txt.push_front(
+            QString::fromUtf8(reinterpret_cast<const char*>(text), size));
+
+        if (hasKey(text, size, "id")) {
+            device_id = txtValue(text, size);
+        } else if (hasKey(text, size, "fn")) {
+            friendly_name = txtValue(text, size);
+        } else if (hasKey(text, size, "md")) {
+            model = txtValue(text, size);
+        } else if (hasKey(text, size, "ca")) {
+            capabilities = txtValue(text, size).toInt();
+        } else if (hasKey(text, size, "rs")) {
+            receiver_status = txtValue(text, size);
+        }
+    }
+}
+
+void Browser::Service::save(QDataStream& out) const {
+    out << service_name << host_name << address << quint16(port) << txt
+        << device_id << friendly_name << model << qint32(capabilities)
+        << receiver_status;
+}
+
+void Browser::Service::load(QDataStream& in) {
+    quint16 cached_port;
+    qint32 cached_capabilities;
+    in >> service_name >> host_name >> address >> cached_port >> txt
+       >> device_id >> friendly_name >> model >> cached_capabilities
+       >> receiver_status;
+    port = cached_port;
+    capabilities = cached_capabilities;
+}
+
+namespace {
+
+// Header of the cache file: "AVBC" and the format version
+const quint32 cache_magic = 0x41564243;
+const quint16 cache_version = 1;
+
+// How long to wait for model changes to settle before saving
+const int cache_save_delay = 5000;
+
+}
+
 Browser::Browser(QObject *parent)
     : QAbstractListModel(parent) {
-    poll_.reset(avahi_glib_poll_new(nullptr, G_PRIORITY_DEFAULT));
-    if (!poll_) {
-        throw std::runtime_error("Could not create AvahiGLibPoll");
-    }
-
-    AvahiServerConfig config_backing { nullptr, };
-    std::unique_ptr<AvahiServerConfig, decltype(&avahi_server_config_free)>
-        config(avahi_server_config_init(&config_backing),
-               avahi_server_config_free);
-    config->publish_hinfo = false;
-    config->publish_addresses = false;
-    config->publish_workstation = false;
-    config->publish_domain = false;
-    config->disable_publishing = true;
-
-    int error = 0;
-    server_.reset(avahi_server_new(
-                      avahi_glib_poll_get(poll_.get()), config.get(),
-                      &Browser::serverCallback, this, &error));
-    if (!server_) {
-        throw std::runtime_error(std::string("Could not create AvahiServer: ")
-                                 + avahi_strerror(error));
-    }
+    server_ = Server::instance();
+    server_->addListener(this);
 
     roles[RoleServiceName] = "serviceName";
     roles[RoleHostName] = "hostName";
     roles[RoleAddress] = "address";
     roles[RolePort] = "port";
     roles[RoleTxt] = "txt";
+    roles[RoleDeviceId] = "deviceId";
+    roles[RoleFriendlyName] = "friendlyName";
+    roles[RoleModel] = "model";
+    roles[RoleCapabilities] = "capabilities";
+    roles[RoleReceiverStatus] = "receiverStatus";
+    roles[RoleStale] = "stale";
+
+    clock_.start();
+    expiry_timer_.setInterval(30 * 1000);
+    connect(&expiry_timer_, &QTimer::timeout,
+            this, &Browser::onExpiryTimeout);
+    expiry_timer_.start();
+
+    save_timer_.setSingleShot(true);
+    save_timer_.setInterval(cache_save_delay);
+    connect(&save_timer_, &QTimer::timeout, this, &Browser::saveCache);
 }
 
-Browser::~Browser() = default;
+Browser::~Browser() {
+    server_->removeListener(this);
+    if (save_timer_.isActive()) {
+        saveCache();
+    }
+}
 
 QString Browser::serviceType() const {
     return service_type_;
 }
 
 void Browser::setServiceType(QString type) {
+    if (save_timer_.isActive()) {
+        saveCache();
+    }
     service_type_ = type;
+    resetServices();
+    loadCache();
     startBrowsing();
 }
 
-void Browser::startBrowsing() {
+void Browser::resetServices() {
+    pending_adds_.clear();
+    pending_removes_.clear();
+    pending_updates_.clear();
     if (!services_.empty()) {
         beginResetModel();
         services_.clear();
+        index_.clear();
         endResetModel();
     }
+    // Dropping the services freed their resolvers
+    resolve_queue_.clear();
+    finished_resolvers_.clear();
+    active_resolvers_ = 0;
+    Q_EMIT resolversChanged();
+}
+
+void Browser::serverRunning() {
+    startBrowsing();
+}
+
+void Browser::startBrowsing() {
+    // Rows the new browser does not report are pruned once it has
+    // caught up
+    for (auto& svc : services_) {
+        svc.seen = false;
+    }
 
     if (service_type_.isEmpty()) return;
-    if (!server_ || avahi_server_get_state(server_.get()) != AVAHI_SERVER_RUNNING) return;
+    if (!server_->isRunning()) return;
 
     browser_.reset(
         avahi_s_service_browser_new(
-            server_.get(), AVAHI_IF_UNSPEC, AVAHI_PROTO_UNSPEC,
+            server_->get(), AVAHI_IF_UNSPEC, AVAHI_PROTO_UNSPEC,
             service_type_.toUtf8().constData(),
             "local", AVAHI_LOOKUP_USE_MULTICAST,
             &Browser::browserCallback, this));
@@ -109,32 +244,40 @@ void Browser::addService(AvahiIfIndex iface,
                          const char *name,
                          const char *type,
                          const char *domain) {
-    Browser::Service svc(name);
-    if (!std::binary_search(services_.begin(), services_.end(), svc)) {
-            // Start resolving the service
-            svc.resolver.reset(
-                avahi_s_service_resolver_new(
-                    server_.get(), iface, protocol,
-                    name, type, domain, AVAHI_PROTO_UNSPEC,
-                    static_cast<AvahiLookupFlags>(0),
-                    &Browser::resolverCallback, this));
-
-            auto it = std::upper_bound(services_.begin(), services_.end(), svc);
-            int index = it - services_.begin();
-            beginInsertRows(QModelIndex(), index, index);
-            services_.emplace(it, std::move(svc));
-            endInsertRows();
-        }
+    const QString service_name = QString::fromUtf8(name);
+    // A service that reappears before its removal was applied keeps
+    // its row, as do cached services
+    pending_removes_.remove(service_name);
+    Service *found = findService(service_name);
+    if (!found) {
+        found = &pending_adds_.emplace(
+            service_name, Service(service_name)).first->second;
+        scheduleFlush();
+    }
+    Service& svc = *found;
+    svc.seen = true;
+    svc.lookup_name = name;
+    svc.type = type;
+    svc.domain = domain;
+    svc.iface = iface;
+    svc.protocol = protocol;
+    if (svc.resolved_at < 0) {
+        queueResolve(svc);
+    }
 }
 
 void Browser::removeService(const char *name) {
-    Browser::Service svc(name);
-    auto it = std::lower_bound(services_.begin(), services_.end(), svc);
-    if (it != services_.end() && it->service_name == svc.service_name) {
-        int index = it - services_.begin();
-        beginRemoveRows(QModelIndex(), index, index);
-        services_.erase(it);
-        endRemoveRows();
+    const QString service_name = QString::fromUtf8(name);
+    auto pending = pending_adds_.find(service_name);
+    if (pending != pending_adds_.end()) {
+        releaseResolver(pending->second);
+        pending_adds_.erase(pending);
+        return;
+    }
+    if (index_.contains(service_name)) {
+        pending_removes_.insert(service_name);
+        pending_updates_.remove(service_name);
+        scheduleFlush();
     }
 }
 
@@ -143,42 +286,339 @@ void Browser::updateService(const char *name,
                             const AvahiAddress *a,
                             uint16_t port,
                             AvahiStringList *txt) {
-    // Find the service in our list
-    Browser::Service s(name);
-    auto it = std::lower_bound(services_.begin(), services_.end(), s);
-    if (it == services_.end() || it->service_name != name) {
-        return;
+    // Find the service in our list, or among those yet to be added
+    const QString service_name = QString::fromUtf8(name);
+    Service *found = nullptr;
+    auto row = index_.constFind(service_name);
+    if (row != index_.constEnd()) {
+        found = &services_[row.value()];
+        pending_updates_.insert(service_name);
+        scheduleFlush();
+    } else {
+        auto it = pending_adds_.find(service_name);
+        if (it == pending_adds_.end()) return;
+        found = &it->second;
     }
-    Browser::Service &svc = *it;
-    auto index = createIndex(it - services_.begin(), 0);
+    Browser::Service &svc = *found;
 
     svc.host_name = host_name;
     char addr[AVAHI_ADDRESS_STR_MAX];
     avahi_address_snprint(addr, sizeof(addr), a);
     svc.address = addr;
     svc.port = port;
-    svc.txt.clear();
-    for (auto item = txt; item != nullptr; item = avahi_string_list_get_next(item)) {
-        // TODO: this probably isn't actually UTF-8
-        svc.txt.push_front(
-            QString::fromUtf8(
-                reinterpret_cast<const char*>(avahi_string_list_get_text(item)),
-                avahi_string_list_get_size(item)));
+    svc.setTxt(txt);
+    svc.stale = false;
+    svc.resolve_failed = false;
+}
+
+void Browser::scheduleFlush() {
+    if (flush_pending_) return;
+    flush_pending_ = true;
+    QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+}
+
+void Browser::flush() {
+    flush_pending_ = false;
+    if (!pending_removes_.isEmpty() || !pending_adds_.empty() ||
+        !pending_updates_.isEmpty()) {
+        save_timer_.start();
     }
-    Q_EMIT dataChanged(index, index);
+    applyRemoves();
+    applyAdds();
+    applyUpdates();
+    finished_resolvers_.clear();
+    startResolvers();
 }
 
-void Browser::serverCallback(AvahiServer *server,
-                             AvahiServerState state,
-                             void *userdata) noexcept {
-    auto browser = static_cast<Browser*>(userdata);
+void Browser::applyRemoves() {
+    if (pending_removes_.isEmpty()) return;
+    std::vector<int> rows;
+    rows.reserve(pending_removes_.size());
+    for (const auto& name : pending_removes_) {
+        rows.push_back(index_.value(name));
+    }
+    pending_removes_.clear();
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+
+    // Remove runs of adjacent rows together, starting from the end
+    // so the rows before each run keep their indices
+    for (size_t i = 0; i < rows.size(); ) {
+        const int last = rows[i];
+        int first = last;
+        while (++i < rows.size() && rows[i] == first - 1) {
+            first = rows[i];
+        }
+        for (int row = first; row <= last; ++row) {
+            releaseResolver(services_[row]);
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        services_.erase(services_.begin() + first,
+                        services_.begin() + last + 1);
+        endRemoveRows();
+    }
+    rebuildIndex();
+}
 
-    switch (state) {
-    case AVAHI_SERVER_RUNNING:
-        browser->startBrowsing();
-        break;
-    default:
-        break;
+void Browser::applyAdds() {
+    if (pending_adds_.empty()) return;
+    // pending_adds_ is sorted by name, so new services that go
+    // between the same pair of existing rows form a run that can be
+    // inserted together.
+    struct Run {
+        int row;
+        std::vector<Service> services;
+    };
+    std::vector<Run> runs;
+    for (auto& entry : pending_adds_) {
+        auto it = std::upper_bound(
+            services_.begin(), services_.end(), entry.second);
+        const int row = it - services_.begin();
+        if (runs.empty() || runs.back().row != row) {
+            runs.push_back(Run{row, {}});
+        }
+        runs.back().services.push_back(std::move(entry.second));
+    }
+    pending_adds_.clear();
+
+    // Insert from the end, so earlier insertion points stay valid
+    for (auto run = runs.rbegin(); run != runs.rend(); ++run) {
+        const int count = run->services.size();
+        beginInsertRows(QModelIndex(), run->row, run->row + count - 1);
+        services_.insert(services_.begin() + run->row,
+                         std::make_move_iterator(run->services.begin()),
+                         std::make_move_iterator(run->services.end()));
+        endInsertRows();
+    }
+    rebuildIndex();
+}
+
+void Browser::applyUpdates() {
+    if (pending_updates_.isEmpty()) return;
+    std::vector<int> rows;
+    rows.reserve(pending_updates_.size());
+    for (const auto& name : pending_updates_) {
+        auto row = index_.constFind(name);
+        if (row != index_.constEnd()) {
+            rows.push_back(row.value());
+        }
+    }
+    pending_updates_.clear();
+    std::sort(rows.begin(), rows.end());
+
+    // Report runs of adjacent rows with one signal each
+    for (size_t i = 0; i < rows.size(); ) {
+        const int first = rows[i];
+        int last = first;
+        while (++i < rows.size() && rows[i] == last + 1) {
+            last = rows[i];
+        }
+        Q_EMIT dataChanged(createIndex(first, 0), createIndex(last, 0));
+    }
+}
+
+void Browser::rebuildIndex() {
+    index_.clear();
+    index_.reserve(services_.size());
+    for (int i = 0; i < static_cast<int>(services_.size()); ++i) {
+        index_.insert(services_[i].service_name, i);
+    }
+}
+
+Browser::Service *Browser::findService(const QString& name) {
+    auto row = index_.constFind(name);
+    if (row != index_.constEnd()) {
+        return &services_[row.value()];
+    }
+    auto it = pending_adds_.find(name);
+    return it != pending_adds_.end() ? &it->second : nullptr;
+}
+
+void Browser::queueResolve(Service& svc) {
+    // Cached services can only be resolved once the browser reports them
+    if (!svc.seen) return;
+    if (svc.resolve_queued || svc.resolver) return;
+    svc.resolve_queued = true;
+    resolve_queue_.push_back(svc.service_name);
+    startResolvers();
+}
+
+void Browser::startResolvers() {
+    bool changed = false;
+    while (active_resolvers_ < max_resolvers_ && !resolve_queue_.empty()) {
+        const QString name = resolve_queue_.front();
+        resolve_queue_.pop_front();
+        changed = true;
+
+        // Skip services that have gone away since being queued
+        Service *svc = findService(name);
+        if (!svc || !svc->resolve_queued || svc->resolver) continue;
+        svc->resolve_queued = false;
+        svc->resolver.reset(
+            avahi_s_service_resolver_new(
+                server_->get(), svc->iface, svc->protocol,
+                svc->lookup_name.constData(), svc->type.constData(),
+                svc->domain.constData(), AVAHI_PROTO_UNSPEC,
+                static_cast<AvahiLookupFlags>(0),
+                &Browser::resolverCallback, this));
+        if (svc->resolver) {
+            ++active_resolvers_;
+        }
+    }
+    if (changed) {
+        Q_EMIT resolversChanged();
+    }
+}
+
+void Browser::releaseResolver(Service& svc) {
+    if (!svc.resolver) return;
+    // Resolvers may be released from their own callback, so free
+    // them on the next flush
+    finished_resolvers_.push_back(std::move(svc.resolver));
+    --active_resolvers_;
+    scheduleFlush();
+    Q_EMIT resolversChanged();
+}
+
+void Browser::resolveFailed(const char *name) {
+    // Rows are only removed when the browser reports the service
+    // gone.  Until then a service that fails to resolve keeps its
+    // last known details, marked stale.
+    const QString service_name = QString::fromUtf8(name);
+    Service *svc = findService(service_name);
+    if (!svc) return;
+    releaseResolver(*svc);
+    svc->resolve_failed = true;
+    if (!svc->stale) {
+        svc->stale = true;
+        if (index_.contains(service_name)) {
+            pending_updates_.insert(service_name);
+            scheduleFlush();
+        }
+    }
+}
+
+void Browser::resolve(const QString& service_name) {
+    Service *svc = findService(service_name);
+    if (svc) {
+        queueResolve(*svc);
+    }
+}
+
+void Browser::resolveAll() {
+    for (auto& svc : services_) {
+        queueResolve(svc);
+    }
+    for (auto& entry : pending_adds_) {
+        queueResolve(entry.second);
+    }
+}
+
+void Browser::onExpiryTimeout() {
+    if (resolve_interval_ <= 0) return;
+    const qint64 expired = clock_.elapsed() - resolve_interval_ * qint64(1000);
+    for (auto& svc : services_) {
+        if (svc.resolve_failed ||
+            (svc.resolved_at >= 0 && svc.resolved_at <= expired)) {
+            queueResolve(svc);
+        }
+    }
+}
+
+void Browser::setMaxResolvers(int max_resolvers) {
+    max_resolvers_ = std::max(max_resolvers, 1);
+    startResolvers();
+}
+
+void Browser::setResolveInterval(int seconds) {
+    resolve_interval_ = seconds;
+}
+
+void Browser::pruneUnseen() {
+    for (const auto& svc : services_) {
+        if (!svc.seen) {
+            pending_removes_.insert(svc.service_name);
+            pending_updates_.remove(svc.service_name);
+        }
+    }
+    if (!pending_removes_.isEmpty()) {
+        scheduleFlush();
+    }
+}
+
+QString Browser::cachePath() const {
+    const QString dir = QStandardPaths::writableLocation(
+        QStandardPaths::CacheLocation);
+    if (dir.isEmpty() || service_type_.isEmpty()) return QString();
+    QString name = service_type_;
+    name.replace(QLatin1Char('/'), QLatin1Char('_'));
+    return dir + QStringLiteral("/avahi-browser/") + name +
+        QStringLiteral(".cache");
+}
+
+void Browser::loadCache() {
+    const QString path = cachePath();
+    if (path.isEmpty()) return;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic;
+    quint16 version;
+    quint32 count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok ||
+        magic != cache_magic || version != cache_version) return;
+
+    std::vector<Service> services;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Service svc{QString()};
+        svc.load(in);
+        svc.stale = true;
+        services.push_back(std::move(svc));
+    }
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring corrupt discovery cache" << path;
+        return;
+    }
+    std::sort(services.begin(), services.end());
+    services.erase(
+        std::unique(services.begin(), services.end(),
+                    [](const Service& a, const Service& b) {
+                        return a.service_name == b.service_name;
+                    }),
+        services.end());
+    if (services.empty()) return;
+
+    beginInsertRows(QModelIndex(), 0, services.size() - 1);
+    services_ = std::move(services);
+    endInsertRows();
+    rebuildIndex();
+}
+
+void Browser::saveCache() {
+    save_timer_.stop();
+    const QString path = cachePath();
+    if (path.isEmpty()) return;
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return;
+
+    // Only services that have been resolved at some point are useful
+    quint32 count = 0;
+    for (const auto& svc : services_) {
+        if (svc.port != 0) ++count;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << cache_magic << cache_version << count;
+    for (const auto& svc : services_) {
+        if (svc.port != 0) {
+            svc.save(out);
+        }
+    }
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Could not save discovery cache" << path;
     }
 }
 
@@ -202,8 +642,11 @@ void Browser::browserCallback(AvahiSServiceBrowser *b,
         printf("Removing %s of type %s in domain %s\n", name, type, domain);
         browser->removeService(name);
         break;
+    case AVAHI_BROWSER_ALL_FOR_NOW:
+        browser->pruneUnseen();
+        break;
     case AVAHI_BROWSER_FAILURE:
-        printf("Error: %s\n", avahi_strerror(avahi_server_errno(browser->server_.get())));
+        printf("Error: %s\n", avahi_strerror(avahi_server_errno(browser->server_->get())));
         break;
     default:
         break;
@@ -226,12 +669,19 @@ void Browser::resolverCallback(AvahiSServiceResolver *r,
     auto browser = static_cast<Browser*>(userdata);
 
     switch (event) {
-    case AVAHI_RESOLVER_FOUND:
+    case AVAHI_RESOLVER_FOUND: {
         printf("Resolved %s to %s\n", name, host_name);
         browser->updateService(name, host_name, a, port, txt);
+        Service *svc = browser->findService(QString::fromUtf8(name));
+        if (svc) {
+            svc->resolved_at = browser->clock_.elapsed();
+            ++browser->completed_resolves_;
+            browser->releaseResolver(*svc);
+        }
         break;
+    }
     case AVAHI_RESOLVER_FAILURE:
-        browser->removeService(name);
+        browser->resolveFailed(name);
         break;
     }
 }
@@ -242,7 +692,7 @@ int Browser::rowCount(const QModelIndex &parent) const {
 
 QVariant Browser::data(const QModelIndex &index, int role) const {
     int i = index.row();
-    if (i < 0 || i > static_cast<int>(services_.size())) return QVariant();
+    if (i < 0 || i >= static_cast<int>(services_.size())) return QVariant();
 
     const Browser::Service& svc = services_[i];
     switch (role) {
@@ -256,6 +706,18 @@ QVariant Browser::data(const QModelIndex &index, int role) const {
         return QVariant(svc.port);
     case RoleTxt:
         return QVariant(svc.txt);
+    case RoleDeviceId:
+        return QVariant(svc.device_id);
+    case RoleFriendlyName:
+        return QVariant(svc.friendly_name);
+    case RoleModel:
+        return QVariant(svc.model);
+    case RoleCapabilities:
+        return QVariant(svc.capabilities);
+    case RoleReceiverStatus:
+        return QVariant(svc.receiver_status);
+    case RoleStale:
+        return QVariant(svc.stale);
     default:
         return QVariant();
     }
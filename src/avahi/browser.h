@@ -19,18 +19,30 @@
 #pragma once
 
 #include <QAbstractListModel>
-#include <avahi-glib/glib-watch.h>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 #include <avahi-core/core.h>
 #include <avahi-core/lookup.h>
 
+#include "server.h"
+
+#include <deque>
+#include <map>
 #include <memory>
 #include <vector>
 
 namespace avahi {
 
-class Browser : public QAbstractListModel {
+class Browser : public QAbstractListModel, private Server::Listener {
     Q_OBJECT
     Q_PROPERTY(QString serviceType READ serviceType WRITE setServiceType)
+    Q_PROPERTY(int maxResolvers READ maxResolvers WRITE setMaxResolvers)
+    Q_PROPERTY(int resolveInterval READ resolveInterval WRITE setResolveInterval)
+    Q_PROPERTY(int activeResolvers READ activeResolvers NOTIFY resolversChanged)
+    Q_PROPERTY(int queuedResolves READ queuedResolves NOTIFY resolversChanged)
+    Q_PROPERTY(int completedResolves READ completedResolves NOTIFY resolversChanged)
 public:
     explicit Browser(QObject *parent=nullptr);
     virtual ~Browser();
@@ -44,17 +56,50 @@ public:
         RoleAddress,
         RolePort,
         RoleTxt,
+        // Cast device properties, parsed from the TXT record
+        RoleDeviceId,
+        RoleFriendlyName,
+        RoleModel,
+        RoleCapabilities,
+        RoleReceiverStatus,
+        // Whether the entry comes from the discovery cache or failed
+        // to resolve, and has not been resolved since
+        RoleStale,
     };
     Q_ENUM(Roles);
 
+    // Resolve a service again, or every service
+    Q_INVOKABLE void resolve(const QString& service_name);
+    Q_INVOKABLE void resolveAll();
+
+Q_SIGNALS:
+    void resolversChanged();
+
 protected:
     QHash<int,QByteArray> roleNames() const override;
 
+private Q_SLOTS:
+    void flush();
+    void onExpiryTimeout();
+    void saveCache();
+
 private:
     QString serviceType() const;
     void setServiceType(QString type);
+    int maxResolvers() const { return max_resolvers_; }
+    void setMaxResolvers(int max_resolvers);
+    int resolveInterval() const { return resolve_interval_; }
+    void setResolveInterval(int seconds);
+    int activeResolvers() const { return active_resolvers_; }
+    int queuedResolves() const { return resolve_queue_.size(); }
+    int completedResolves() const { return completed_resolves_; }
+
+    struct Service;
 
+    void resetServices();
+    void serverRunning() override;
     void startBrowsing();
+    void pruneUnseen();
     void addService(AvahiIfIndex iface,
                     AvahiProtocol protocol,
                     const char *name,
@@ -67,9 +112,22 @@ private:
                        uint16_t port,
                        AvahiStringList *txt);
 
-    static void serverCallback(AvahiServer *s,
-                               AvahiServerState state,
-                               void *userdata) noexcept;
+    // Model changes are collected and applied once per event loop
+    // iteration, as range inserts and removes
+    void scheduleFlush();
+    void applyRemoves();
+    void applyAdds();
+    void applyUpdates();
+    void rebuildIndex();
+
+    // Resolvers are one-shot, and at most maxResolvers run at once.
+    // The rest wait in a queue.
+    Service *findService(const QString& name);
+    void queueResolve(Service& svc);
+    void startResolvers();
+    void releaseResolver(Service& svc);
+    void resolveFailed(const char *name);
+
     static void browserCallback(AvahiSServiceBrowser *b,
                                 AvahiIfIndex iface,
                                 AvahiProtocol protocol,
@@ -95,16 +153,43 @@ private:
 
     QHash<int, QByteArray> roles;
 
-    std::unique_ptr<AvahiGLibPoll, decltype(&avahi_glib_poll_free)> poll_
-        {nullptr, avahi_glib_poll_free};
-    std::unique_ptr<AvahiServer, decltype(&avahi_server_free)> server_
-        {nullptr, avahi_server_free};
+    // Shared with the other browsers, and declared first so it
+    // outlives the browser and resolvers made through it
+    std::shared_ptr<Server> server_;
     std::unique_ptr<AvahiSServiceBrowser, decltype(&avahi_s_service_browser_free)> browser_
         {nullptr, avahi_s_service_browser_free};
     QString service_type_;
 
-    struct Service;
+    // Rows sorted by service name, and each name's row
     std::vector<Service> services_;
+    QHash<QString,int> index_;
+
+    // Changes waiting for the next flush: services not yet in the
+    // model, names of rows to remove, and names of rows re-resolved
+    std::map<QString,Service> pending_adds_;
+    QSet<QString> pending_removes_;
+    QSet<QString> pending_updates_;
+    bool flush_pending_ = false;
+
+    // Manage resolvers.  Services are resolved again after
+    // resolve_interval_ seconds, by default the 120 second TTL of SRV
+    // and address records (RFC 6762 section 10), so a device that
+    // changes address is picked up as soon as its records expire.
+    int max_resolvers_ = 8;
+    int resolve_interval_ = 120;
+    int active_resolvers_ = 0;
+    int completed_resolves_ = 0;
+    std::deque<QString> resolve_queue_;
+    // Resolvers that have finished, freed outside their callbacks
+    std::vector<std::unique_ptr<AvahiSServiceResolver, decltype(&avahi_s_service_resolver_free)>> finished_resolvers_;
+    QElapsedTimer clock_;
+    QTimer expiry_timer_;
+
+    // Resolved services are cached on disk, so the model can be
+    // filled as soon as the service type is set
+    void loadCache();
+    QString cachePath() const;
+    QTimer save_timer_;
 };
 
 }
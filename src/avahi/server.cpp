@@ -0,0 +1,105 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server.h"
+
+#include <avahi-common/error.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace avahi {
+
+std::shared_ptr<Server> Server::instance() {
+    static std::weak_ptr<Server> shared;
+
+    std::shared_ptr<Server> server = shared.lock();
+    if (!server) {
+        server.reset(new Server);
+        shared = server;
+    }
+    return server;
+}
+
+Server::Server() {
+    poll_.reset(avahi_glib_poll_new(nullptr, G_PRIORITY_DEFAULT));
+    if (!poll_) {
+        throw std::runtime_error("Could not create AvahiGLibPoll");
+    }
+
+    AvahiServerConfig config_backing { nullptr, };
+    std::unique_ptr<AvahiServerConfig, decltype(&avahi_server_config_free)>
+        config(avahi_server_config_init(&config_backing),
+               avahi_server_config_free);
+    config->publish_hinfo = false;
+    config->publish_addresses = false;
+    config->publish_workstation = false;
+    config->publish_domain = false;
+    config->disable_publishing = true;
+
+    int error = 0;
+    server_.reset(avahi_server_new(
+                      avahi_glib_poll_get(poll_.get()), config.get(),
+                      &Server::serverCallback, this, &error));
+    if (!server_) {
+        throw std::runtime_error(std::string("Could not create AvahiServer: ")
+                                 + avahi_strerror(error));
+    }
+}
+
+Server::~Server() = default;
+
+bool Server::isRunning() const {
+    return server_ &&
+        avahi_server_get_state(server_.get()) == AVAHI_SERVER_RUNNING;
+}
+
+void Server::addListener(Listener *listener) {
+    listeners_.push_back(listener);
+}
+
+void Server::removeListener(Listener *listener) {
+    listeners_.erase(
+        std::remove(listeners_.begin(), listeners_.end(), listener),
+        listeners_.end());
+}
+
+void Server::serverCallback(AvahiServer *s,
+                            AvahiServerState state,
+                            void *userdata) noexcept {
+    auto server = static_cast<Server*>(userdata);
+
+    switch (state) {
+    case AVAHI_SERVER_RUNNING: {
+        // A listener may start lookups that add or remove listeners
+        const std::vector<Listener*> listeners = server->listeners_;
+        for (auto listener : listeners) {
+            if (std::find(server->listeners_.begin(), server->listeners_.end(),
+                          listener) != server->listeners_.end()) {
+                listener->serverRunning();
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <avahi-glib/glib-watch.h>
+#include <avahi-core/core.h>
+
+#include <memory>
+#include <vector>
+
+namespace avahi {
+
+/* Server is the embedded mDNS responder and its GLib poll, shared by
+ * every Browser in the process.  It is created by the first Browser,
+ * and freed when the last one lets go of it.  Like the poll it runs
+ * on, it must only be used from the main thread.
+ */
+class Server {
+public:
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+        // Called when the server enters the running state, after
+        // which lookups can be made
+        virtual void serverRunning() = 0;
+    };
+
+    // The shared server, created if no Browser currently holds it
+    static std::shared_ptr<Server> instance();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+    ~Server();
+
+    AvahiServer *get() const { return server_.get(); }
+    bool isRunning() const;
+
+    void addListener(Listener *listener);
+    void removeListener(Listener *listener);
+
+private:
+    Server();
+
+    static void serverCallback(AvahiServer *s,
+                               AvahiServerState state,
+                               void *userdata) noexcept;
+
+    std::unique_ptr<AvahiGLibPoll, decltype(&avahi_glib_poll_free)> poll_
+        {nullptr, avahi_glib_poll_free};
+    std::unique_ptr<AvahiServer, decltype(&avahi_server_free)> server_
+        {nullptr, avahi_server_free};
+    std::vector<Listener*> listeners_;
+};
+
+}
@@ -0,0 +1,158 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "application-model.h"
+
+#include <QStringList>
+#include <QVector>
+
+#include <utility>
+
+namespace cast {
+
+namespace {
+
+QString sessionId(const QJsonObject& application) {
+    return application["sessionId"].toString();
+}
+
+}
+
+ApplicationModel::ApplicationModel(QObject *parent)
+    : QAbstractListModel(parent) {
+    roles[RoleAppId] = "appId";
+    roles[RoleDisplayName] = "displayName";
+    roles[RoleSessionId] = "sessionId";
+    roles[RoleTransportId] = "transportId";
+    roles[RoleStatusText] = "statusText";
+    roles[RoleIsIdleScreen] = "isIdleScreen";
+    roles[RoleNamespaces] = "namespaces";
+    roles[RoleApplication] = "application";
+}
+
+ApplicationModel::~ApplicationModel() = default;
+
+int ApplicationModel::findRow(const QString& session_id, int from) const {
+    for (int i = from; i < static_cast<int>(applications_.size()); ++i) {
+        if (sessionId(applications_[i]) == session_id) return i;
+    }
+    return -1;
+}
+
+void ApplicationModel::update(const QJsonArray& applications) {
+    QStringList session_ids;
+    for (const auto& value : applications) {
+        session_ids.append(sessionId(value.toObject()));
+    }
+
+    // Remove applications that are no longer running
+    for (int i = static_cast<int>(applications_.size()) - 1; i >= 0; --i) {
+        if (!session_ids.contains(sessionId(applications_[i]))) {
+            beginRemoveRows(QModelIndex(), i, i);
+            applications_.erase(applications_.begin() + i);
+            endRemoveRows();
+        }
+    }
+
+    // Then move, update or insert the rest to match the new order
+    for (int i = 0; i < applications.size(); ++i) {
+        const QJsonObject application = applications[i].toObject();
+        const int row = findRow(session_ids[i], i);
+        if (row == i) {
+            updateRow(i, application);
+        } else if (row > i) {
+            beginMoveRows(QModelIndex(), row, row, QModelIndex(), i);
+            const QJsonObject moved = applications_[row];
+            applications_.erase(applications_.begin() + row);
+            applications_.insert(applications_.begin() + i, moved);
+            endMoveRows();
+            updateRow(i, application);
+        } else {
+            beginInsertRows(QModelIndex(), i, i);
+            applications_.insert(applications_.begin() + i, application);
+            endInsertRows();
+        }
+    }
+}
+
+void ApplicationModel::updateRow(int row, const QJsonObject& application) {
+    QJsonObject& old = applications_[row];
+    if (old == application) return;
+
+    static const std::pair<const char*,int> fields[] = {
+        {"appId", RoleAppId},
+        {"displayName", RoleDisplayName},
+        {"transportId", RoleTransportId},
+        {"statusText", RoleStatusText},
+        {"isIdleScreen", RoleIsIdleScreen},
+        {"namespaces", RoleNamespaces},
+    };
+    QVector<int> changed;
+    for (const auto& field : fields) {
+        const QString key = QLatin1String(field.first);
+        if (old.value(key) != application.value(key)) {
+            changed.append(field.second);
+        }
+    }
+    changed.append(RoleApplication);
+    old = application;
+    const auto index = createIndex(row, 0);
+    Q_EMIT dataChanged(index, index, changed);
+}
+
+int ApplicationModel::rowCount(const QModelIndex &parent) const {
+    return applications_.size();
+}
+
+QVariant ApplicationModel::data(const QModelIndex &index, int role) const {
+    int i = index.row();
+    if (i < 0 || i >= static_cast<int>(applications_.size())) return QVariant();
+
+    const QJsonObject& app = applications_[i];
+    switch (role) {
+    case RoleAppId:
+        return app["appId"].toVariant();
+    case RoleDisplayName:
+        return app["displayName"].toVariant();
+    case RoleSessionId:
+        return app["sessionId"].toVariant();
+    case RoleTransportId:
+        return app["transportId"].toVariant();
+    case RoleStatusText:
+        return app["statusText"].toVariant();
+    case RoleIsIdleScreen:
+        return app["isIdleScreen"].toBool();
+    case RoleNamespaces: {
+        QStringList names;
+        for (const auto& ns : app["namespaces"].toArray()) {
+            names.append(ns.toObject()["name"].toString());
+        }
+        return names;
+    }
+    case RoleApplication:
+        return app.toVariantMap();
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int,QByteArray> ApplicationModel::roleNames() const {
+    return roles;
+}
+
+}
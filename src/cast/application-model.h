@@ -0,0 +1,68 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <vector>
+
+namespace cast {
+
+/* ApplicationModel lists the applications running on a receiver,
+ * keyed on their sessionId.  Status updates are applied in place, so
+ * views only see the rows and roles that actually changed.
+ */
+class ApplicationModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit ApplicationModel(QObject *parent=nullptr);
+    virtual ~ApplicationModel();
+
+    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    enum Roles {
+        RoleAppId = Qt::UserRole + 1,
+        RoleDisplayName,
+        RoleSessionId,
+        RoleTransportId,
+        RoleStatusText,
+        RoleIsIdleScreen,
+        RoleNamespaces,
+        RoleApplication,
+    };
+    Q_ENUM(Roles);
+
+    // Apply the "applications" list from a RECEIVER_STATUS message
+    void update(const QJsonArray& applications);
+
+protected:
+    QHash<int,QByteArray> roleNames() const override;
+
+private:
+    int findRow(const QString& session_id, int from) const;
+    void updateRow(int row, const QJsonObject& application);
+
+    QHash<int, QByteArray> roles;
+    std::vector<QJsonObject> applications_;
+};
+
+}
@@ -0,0 +1,222 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cast-message.h"
+#include "wire-format.h"
+
+namespace cast {
+
+namespace {
+
+bool readVarint(const char *&p, const char *end, uint64_t& value,
+                int max_bytes=10) {
+    value = 0;
+    for (int shift = 0; shift < 7 * max_bytes && p < end; shift += 7) {
+        const uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool skipField(const char *&p, const char *end, uint32_t tag, int depth=0) {
+    uint64_t value;
+    switch (tag & 7) {
+    case 0:
+        return readVarint(p, end, value);
+    case 1:
+        if (end - p < 8) return false;
+        p += 8;
+        return true;
+    case 2:
+        if (!readVarint(p, end, value, 5) ||
+            value > static_cast<uint64_t>(end - p)) return false;
+        p += value;
+        return true;
+    case 3:
+        // Skip a group, up to the matching end group tag
+        if (depth >= 100) return false;
+        while (p < end) {
+            uint64_t inner;
+            if (!readVarint(p, end, inner, 5) ||
+                static_cast<uint32_t>(inner) < 8) return false;
+            if (static_cast<uint32_t>(inner) == (tag & ~7u) + 4) return true;
+            if (!skipField(p, end, static_cast<uint32_t>(inner), depth + 1)) {
+                return false;
+            }
+        }
+        return false;
+    case 5:
+        if (end - p < 4) return false;
+        p += 4;
+        return true;
+    default:
+        return false;
+    }
+}
+
+int bytesFieldSize(wire::Field field, const ByteView& value) {
+    return wire::tagSize(field) + wire::varintSize(value.size()) + value.size();
+}
+
+char *writeBytesField(char *out, wire::Field field, const ByteView& value) {
+    out = wire::writeTag(out, field, wire::WireType::length_delimited);
+    out = wire::writeVarint(out, value.size());
+    memcpy(out, value.data(), value.size());
+    return out + value.size();
+}
+
+}
+
+bool CastMessage::parse(const char *data, uint32_t size) {
+    enum {
+        HAS_PROTOCOL_VERSION = 1 << 0,
+        HAS_SOURCE_ID = 1 << 1,
+        HAS_DESTINATION_ID = 1 << 2,
+        HAS_NAMESPACE = 1 << 3,
+        HAS_PAYLOAD_TYPE = 1 << 4,
+        HAS_REQUIRED = (1 << 5) - 1,
+    };
+    unsigned present = 0;
+    has_payload_utf8_ = has_payload_binary_ = false;
+    payload_utf8_ = payload_binary_ = ByteView();
+
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end) {
+        // Tags are read as at most five bytes, truncated to 32 bits
+        uint64_t tag64;
+        if (!readVarint(p, end, tag64, 5)) return false;
+        const uint32_t tag = static_cast<uint32_t>(tag64);
+        const uint32_t field = tag >> 3;
+        const uint32_t wire_type = tag & 7;
+        if (field == 0) return false;
+
+        if (wire_type == static_cast<uint32_t>(wire::WireType::varint) &&
+            (field == 1 || field == 5)) {
+            uint64_t value;
+            if (!readVarint(p, end, value)) return false;
+            // Enums are decoded as int32, and unknown values leave
+            // the field unset, as the generated code does
+            const int32_t v = static_cast<int32_t>(value);
+            if (field == 1) {
+                if (v == CASTV2_1_0) {
+                    protocol_version_ = CASTV2_1_0;
+                    present |= HAS_PROTOCOL_VERSION;
+                }
+            } else if (v == STRING || v == BINARY) {
+                payload_type_ = static_cast<PayloadType>(v);
+                present |= HAS_PAYLOAD_TYPE;
+            }
+        } else if (wire_type == static_cast<uint32_t>(wire::WireType::length_delimited) &&
+                   field >= 2 && field <= 7 && field != 5) {
+            uint64_t length;
+            if (!readVarint(p, end, length, 5) ||
+                length > static_cast<uint64_t>(end - p)) return false;
+            const ByteView value(p, length);
+            p += length;
+            switch (field) {
+            case 2:
+                source_id_ = value;
+                present |= HAS_SOURCE_ID;
+                break;
+            case 3:
+                destination_id_ = value;
+                present |= HAS_DESTINATION_ID;
+                break;
+            case 4:
+                namespace__ = value;
+                present |= HAS_NAMESPACE;
+                break;
+            case 6:
+                payload_utf8_ = value;
+                has_payload_utf8_ = true;
+                break;
+            case 7:
+                payload_binary_ = value;
+                has_payload_binary_ = true;
+                break;
+            }
+        } else if (!skipField(p, end, tag)) {
+            return false;
+        }
+    }
+    return present == HAS_REQUIRED;
+}
+
+bool CastMessage::peekNamespace(const char *data, uint32_t size,
+                                ByteView& ns) {
+    const uint32_t namespace_tag =
+        (static_cast<uint32_t>(wire::Field::namespace_) << 3) |
+        static_cast<uint32_t>(wire::WireType::length_delimited);
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end) {
+        uint64_t tag;
+        if (!readVarint(p, end, tag, 5) || static_cast<uint32_t>(tag) < 8) {
+            return false;
+        }
+        if (static_cast<uint32_t>(tag) == namespace_tag) {
+            uint64_t length;
+            if (!readVarint(p, end, length, 5) ||
+                length > static_cast<uint64_t>(end - p)) return false;
+            ns = ByteView(p, length);
+            return true;
+        }
+        if (!skipField(p, end, static_cast<uint32_t>(tag))) return false;
+    }
+    return false;
+}
+
+int CastMessage::byteSize() const {
+    int size = wire::tagSize(wire::Field::protocol_version)
+        + wire::varintSize(protocol_version_)
+        + bytesFieldSize(wire::Field::source_id, source_id_)
+        + bytesFieldSize(wire::Field::destination_id, destination_id_)
+        + bytesFieldSize(wire::Field::namespace_, namespace__)
+        + wire::tagSize(wire::Field::payload_type)
+        + wire::varintSize(payload_type_);
+    if (has_payload_utf8_) {
+        size += bytesFieldSize(wire::Field::payload_utf8, payload_utf8_);
+    }
+    if (has_payload_binary_) {
+        size += bytesFieldSize(wire::Field::payload_binary, payload_binary_);
+    }
+    return size;
+}
+
+char *CastMessage::serializeTo(char *out) const {
+    out = wire::writeTag(out, wire::Field::protocol_version,
+                         wire::WireType::varint);
+    out = wire::writeVarint(out, protocol_version_);
+    out = writeBytesField(out, wire::Field::source_id, source_id_);
+    out = writeBytesField(out, wire::Field::destination_id, destination_id_);
+    out = writeBytesField(out, wire::Field::namespace_, namespace__);
+    out = wire::writeTag(out, wire::Field::payload_type,
+                         wire::WireType::varint);
+    out = wire::writeVarint(out, payload_type_);
+    if (has_payload_utf8_) {
+        out = writeBytesField(out, wire::Field::payload_utf8, payload_utf8_);
+    }
+    if (has_payload_binary_) {
+        out = writeBytesField(out, wire::Field::payload_binary, payload_binary_);
+    }
+    return out;
+}
+
+}
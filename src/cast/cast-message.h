@@ -0,0 +1,122 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace cast {
+
+/* A reference to a run of bytes owned by someone else, typically a
+ * field within a received frame.
+ */
+class ByteView {
+public:
+    ByteView() = default;
+    ByteView(const char *data, int size) : data_(data), size_(size) {}
+    ByteView(const std::string& s) : data_(s.data()), size_(s.size()) {}
+
+    const char *data() const { return data_; }
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    bool operator==(const ByteView& other) const {
+        return size_ == other.size_ && memcmp(data_, other.data_, size_) == 0;
+    }
+    template <int N>
+    bool operator==(const char (&literal)[N]) const {
+        return size_ == N - 1 && memcmp(data_, literal, N - 1) == 0;
+    }
+
+private:
+    const char *data_ = "";
+    int size_ = 0;
+};
+
+/* CastMessage encodes and decodes the CastMessage protocol buffer
+ * described in proto/cast_channel.proto, without the protobuf
+ * runtime.  The accessors follow the generated code's names.
+ *
+ * String fields are views: after parse() they refer into the decoded
+ * buffer, and when encoding they refer to the caller's data.  Either
+ * way the underlying bytes must outlive the message.
+ */
+class CastMessage {
+public:
+    enum ProtocolVersion {
+        CASTV2_1_0 = 0,
+    };
+    enum PayloadType {
+        STRING = 0,
+        BINARY = 1,
+    };
+
+    // Decode a message.  Like ParseFromArray(), this fails if the
+    // input is malformed or a required field is missing.
+    bool parse(const char *data, uint32_t size);
+
+    // Find the namespace of an encoded message, reading no further
+    // than the namespace field.  The payload fields follow it in
+    // messages from well behaved senders, and are not examined.
+    static bool peekNamespace(const char *data, uint32_t size, ByteView& ns);
+
+    // The encoded size of the message, and encode it into out, which
+    // must have room for byteSize() bytes.  Returns the end of the
+    // encoded message.
+    int byteSize() const;
+    char *serializeTo(char *out) const;
+
+    ProtocolVersion protocol_version() const { return protocol_version_; }
+    const ByteView& source_id() const { return source_id_; }
+    const ByteView& destination_id() const { return destination_id_; }
+    const ByteView& namespace_() const { return namespace__; }
+    PayloadType payload_type() const { return payload_type_; }
+    bool has_payload_utf8() const { return has_payload_utf8_; }
+    const ByteView& payload_utf8() const { return payload_utf8_; }
+    bool has_payload_binary() const { return has_payload_binary_; }
+    const ByteView& payload_binary() const { return payload_binary_; }
+
+    void set_protocol_version(ProtocolVersion v) { protocol_version_ = v; }
+    void set_source_id(ByteView v) { source_id_ = v; }
+    void set_destination_id(ByteView v) { destination_id_ = v; }
+    void set_namespace_(ByteView v) { namespace__ = v; }
+    void set_payload_type(PayloadType v) { payload_type_ = v; }
+    void set_payload_utf8(ByteView v) {
+        payload_utf8_ = v;
+        has_payload_utf8_ = true;
+    }
+    void set_payload_binary(ByteView v) {
+        payload_binary_ = v;
+        has_payload_binary_ = true;
+    }
+
+private:
+    ProtocolVersion protocol_version_ = CASTV2_1_0;
+    ByteView source_id_;
+    ByteView destination_id_;
+    ByteView namespace__;
+    PayloadType payload_type_ = STRING;
+    ByteView payload_utf8_;
+    ByteView payload_binary_;
+    bool has_payload_utf8_ = false;
+    bool has_payload_binary_ = false;
+};
+
+}
@@ -0,0 +1,223 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "caster-pool.h"
+#include "caster.h"
+#include "channel.h"
+#include "interface.h"
+#include "receiver-interface.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+namespace cast {
+
+namespace {
+
+const QEvent::Type function_event_type =
+    static_cast<QEvent::Type>(QEvent::registerEventType());
+
+class FunctionEvent : public QEvent {
+public:
+    explicit FunctionEvent(std::function<void()> fn)
+        : QEvent(function_event_type), fn_(std::move(fn)) {}
+
+    void run() { fn_(); }
+
+private:
+    std::function<void()> fn_;
+};
+
+// Runs functions posted to it in the thread it lives in
+class ShardContext : public QObject {
+public:
+    bool event(QEvent *e) override {
+        if (e->type() == function_event_type) {
+            static_cast<FunctionEvent*>(e)->run();
+            return true;
+        }
+        return QObject::event(e);
+    }
+};
+
+}
+
+struct CasterPool::Shard {
+    QThread thread;
+    ShardContext context;
+    // Number of devices placed on this shard, guarded by the pool's mutex
+    int devices = 0;
+
+    Shard() {
+        context.moveToThread(&thread);
+        thread.start();
+    }
+
+    void post(std::function<void()> fn) {
+        QCoreApplication::postEvent(&context, new FunctionEvent(std::move(fn)));
+    }
+};
+
+CasterPool::CasterPool(QObject *parent)
+    : QObject(parent),
+      thread_count_(std::max(QThread::idealThreadCount(), 1)) {
+}
+
+CasterPool::~CasterPool() {
+    // Stop the shards without holding the lock: functions still queued
+    // on them may call back into the pool.
+    QHash<int,Device> devices;
+    {
+        QMutexLocker lock(&mutex_);
+        devices.swap(devices_);
+    }
+    for (auto it = devices.begin(); it != devices.end(); ++it) {
+        Caster *caster = it.value().caster;
+        it.value().shard->post([caster]() { delete caster; });
+    }
+    stopShards();
+}
+
+int CasterPool::threadCount() const {
+    return thread_count_;
+}
+
+void CasterPool::setThreadCount(int thread_count) {
+    QMutexLocker lock(&mutex_);
+    if (!shards_.empty()) {
+        qWarning() << "Can not change thread count once devices are added";
+        return;
+    }
+    thread_count_ = std::max(thread_count, 1);
+}
+
+int CasterPool::deviceCount() const {
+    QMutexLocker lock(&mutex_);
+    return devices_.size();
+}
+
+void CasterPool::startShards() {
+    for (int i = 0; i < thread_count_; ++i) {
+        shards_.emplace_back(new Shard);
+    }
+}
+
+void CasterPool::stopShards() {
+    // Quit each thread once the functions already posted to it have run
+    for (auto& shard : shards_) {
+        shard->post([]() { QThread::currentThread()->quit(); });
+    }
+    for (auto& shard : shards_) {
+        shard->thread.wait();
+    }
+    shards_.clear();
+}
+
+int CasterPool::addDevice(const QString& host_name, int port) {
+    Caster *caster = new Caster;
+    int device_id;
+    Shard *shard;
+    {
+        QMutexLocker lock(&mutex_);
+        if (shards_.empty()) {
+            startShards();
+        }
+        shard = std::min_element(
+            shards_.begin(), shards_.end(),
+            [](const std::unique_ptr<Shard>& a, const std::unique_ptr<Shard>& b) {
+                return a->devices < b->devices;
+            })->get();
+        ++shard->devices;
+        device_id = ++last_device_id_;
+        devices_.insert(device_id, {caster, shard});
+    }
+
+    connect(caster, &Caster::connected, this, [this, device_id]() {
+            Q_EMIT deviceConnected(device_id);
+        });
+    connect(caster, &Caster::disconnected, this, [this, device_id]() {
+            Q_EMIT deviceDisconnected(device_id);
+        });
+    caster->moveToThread(&shard->thread);
+    shard->post([caster, host_name, port]() {
+            caster->connectToHost(host_name, port);
+        });
+    Q_EMIT deviceCountChanged();
+    return device_id;
+}
+
+void CasterPool::removeDevice(int device_id) {
+    {
+        QMutexLocker lock(&mutex_);
+        auto it = devices_.find(device_id);
+        if (it == devices_.end()) return;
+        Caster *caster = it.value().caster;
+        --it.value().shard->devices;
+        it.value().shard->post([caster]() {
+                caster->disconnectFromHost();
+                delete caster;
+            });
+        devices_.erase(it);
+    }
+    Q_EMIT deviceCountChanged();
+}
+
+bool CasterPool::invoke(int device_id, std::function<void(Caster*)> fn) {
+    // Post while holding the lock, so the function is queued before
+    // any removal of the device.
+    QMutexLocker lock(&mutex_);
+    auto it = devices_.find(device_id);
+    if (it == devices_.end()) return false;
+    Caster *caster = it.value().caster;
+    it.value().shard->post([caster, fn]() { fn(caster); });
+    return true;
+}
+
+bool CasterPool::launch(int device_id, const QString& app_id) {
+    return invoke(device_id, [app_id](Caster *caster) {
+            if (caster->receiver()) {
+                caster->receiver()->launch(app_id);
+            }
+        });
+}
+
+bool CasterPool::stop(int device_id, const QString& session_id) {
+    return invoke(device_id, [session_id](Caster *caster) {
+            if (caster->receiver()) {
+                caster->receiver()->stop(session_id);
+            }
+        });
+}
+
+bool CasterPool::send(int device_id, const QString& source_id,
+                      const QString& destination_id,
+                      const QString& ns, const QString& data) {
+    return invoke(device_id, [=](Caster *caster) {
+            Interface *iface = caster->createChannel(source_id, destination_id)
+                ->addInterface(ns);
+            if (iface) {
+                iface->send(data);
+            }
+        });
+}
+
+}
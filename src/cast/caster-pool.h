@@ -0,0 +1,90 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cast {
+
+class Caster;
+
+/* CasterPool manages connections to many devices, spread over a fixed
+ * set of worker threads.  Each device's Caster lives entirely in one
+ * worker thread, along with its socket, channels and heartbeats.  New
+ * devices are placed on the worker with the fewest devices.
+ *
+ * Devices are identified by the integer returned from addDevice().
+ * The command methods may be called from any thread: they are
+ * forwarded to the worker thread that owns the device.
+ */
+class CasterPool : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int threadCount READ threadCount WRITE setThreadCount)
+    Q_PROPERTY(int deviceCount READ deviceCount NOTIFY deviceCountChanged)
+public:
+    explicit CasterPool(QObject *parent=nullptr);
+    virtual ~CasterPool();
+
+    Q_INVOKABLE int addDevice(const QString& host_name, int port);
+    Q_INVOKABLE void removeDevice(int device_id);
+
+    Q_INVOKABLE bool launch(int device_id, const QString& app_id);
+    Q_INVOKABLE bool stop(int device_id, const QString& session_id);
+    Q_INVOKABLE bool send(int device_id, const QString& source_id,
+                          const QString& destination_id,
+                          const QString& ns, const QString& data);
+
+    // Run a function against the device's Caster in its worker
+    // thread.  Returns false if there is no such device.
+    bool invoke(int device_id, std::function<void(Caster*)> fn);
+
+Q_SIGNALS:
+    void deviceConnected(int device_id);
+    void deviceDisconnected(int device_id);
+    void deviceCountChanged();
+
+private:
+    int threadCount() const;
+    void setThreadCount(int thread_count);
+    int deviceCount() const;
+    void startShards();
+    void stopShards();
+
+    struct Shard;
+    struct Device {
+        Caster *caster;
+        Shard *shard;
+    };
+
+    int thread_count_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    mutable QMutex mutex_;
+    QHash<int,Device> devices_;
+    int last_device_id_ = 0;
+};
+
+}
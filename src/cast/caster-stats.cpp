@@ -0,0 +1,126 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "caster-stats.h"
+
+#include <QMutexLocker>
+
+namespace cast {
+
+const QString CasterStats::OTHER_DROPPED = QStringLiteral("other");
+
+CasterStats::CasterStats(QObject *parent) : QObject(parent) {
+}
+
+CasterStats::~CasterStats() = default;
+
+NamespaceStats& CasterStats::forNamespace(const QString& ns) {
+    QMutexLocker lock(&mutex_);
+    auto& stats = namespaces_[ns];
+    if (!stats) {
+        stats = std::make_shared<NamespaceStats>();
+    }
+    return *stats;
+}
+
+void CasterStats::countDropped(const QByteArray& ns, uint64_t bytes) {
+    QMutexLocker lock(&mutex_);
+    auto it = dropped_.find(ns);
+    if (it == dropped_.end()) {
+        // The overflow bucket does not count towards the limit
+        const QByteArray other = OTHER_DROPPED.toUtf8();
+        const int tracked = dropped_.size() - (dropped_.contains(other) ? 1 : 0);
+        if (tracked < MAX_DROPPED_NAMESPACES) {
+            // ns may wrap the frame's buffer, so the key is a deep copy
+            it = dropped_.insert(QByteArray(ns.constData(), ns.size()),
+                                 DropStats());
+        } else {
+            it = dropped_.find(other);
+            if (it == dropped_.end()) {
+                it = dropped_.insert(other, DropStats());
+            }
+        }
+    }
+    ++it->messages;
+    it->bytes += bytes;
+}
+
+QStringList CasterStats::namespaces() const {
+    QMutexLocker lock(&mutex_);
+    QStringList result = namespaces_.keys();
+    for (auto it = dropped_.constBegin(); it != dropped_.constEnd(); ++it) {
+        const QString ns = QString::fromUtf8(it.key());
+        if (!namespaces_.contains(ns)) {
+            result.append(ns);
+        }
+    }
+    return result;
+}
+
+QVariantMap CasterStats::namespaceStats(const QString& ns) const {
+    std::shared_ptr<NamespaceStats> stats;
+    DropStats dropped;
+    bool has_drops;
+    {
+        QMutexLocker lock(&mutex_);
+        stats = namespaces_.value(ns);
+        auto it = dropped_.constFind(ns.toUtf8());
+        has_drops = it != dropped_.constEnd();
+        if (has_drops) {
+            dropped = *it;
+        }
+    }
+    QVariantMap result;
+    if (has_drops || stats) {
+        result["messagesDropped"] = qulonglong(dropped.messages);
+        result["bytesDropped"] = qulonglong(dropped.bytes);
+    }
+    if (!stats) return result;
+
+    result["messagesSent"] = qulonglong(stats->messages_sent.load());
+    result["bytesSent"] = qulonglong(stats->bytes_sent.load());
+    result["messagesReceived"] = qulonglong(stats->messages_received.load());
+    result["bytesReceived"] = qulonglong(stats->bytes_received.load());
+    const auto& latency = stats->request_latency;
+    result["requests"] = qulonglong(latency.count());
+    result["p50"] = qulonglong(latency.percentile(50));
+    result["p90"] = qulonglong(latency.percentile(90));
+    result["p99"] = qulonglong(latency.percentile(99));
+    result["max"] = qulonglong(latency.max());
+    return result;
+}
+
+double CasterStats::latencyPercentile(const QString& ns, double percent) const {
+    QMutexLocker lock(&mutex_);
+    auto stats = namespaces_.value(ns);
+    return stats ? stats->request_latency.percentile(percent) : 0.0;
+}
+
+void CasterStats::reset() {
+    QMutexLocker lock(&mutex_);
+    for (const auto& stats : namespaces_) {
+        stats->messages_sent.store(0);
+        stats->bytes_sent.store(0);
+        stats->messages_received.store(0);
+        stats->bytes_received.store(0);
+        stats->request_latency.reset();
+    }
+    dropped_.clear();
+}
+
+}
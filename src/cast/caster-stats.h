@@ -0,0 +1,96 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "latency-histogram.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace cast {
+
+// Counters for the traffic on one namespace.  Updated lock-free.
+struct NamespaceStats {
+    std::atomic<uint64_t> messages_sent{0};
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<uint64_t> messages_received{0};
+    std::atomic<uint64_t> bytes_received{0};
+    // Round trip time of requests, from sending to the reply with
+    // the matching requestId
+    LatencyHistogram request_latency;
+
+    void countSent(uint64_t bytes) {
+        messages_sent.fetch_add(1, std::memory_order_relaxed);
+        bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    void countReceived(uint64_t bytes) {
+        messages_received.fetch_add(1, std::memory_order_relaxed);
+        bytes_received.fetch_add(bytes, std::memory_order_relaxed);
+    }
+};
+
+// Frames discarded because no interface handles the namespace
+struct DropStats {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+};
+
+/* CasterStats collects per-namespace traffic counters and request
+ * latency histograms for all channels of a Caster.  The query methods
+ * may be called from any thread.
+ */
+class CasterStats : public QObject {
+    Q_OBJECT
+public:
+    explicit CasterStats(QObject *parent=nullptr);
+    virtual ~CasterStats();
+
+    // The counters for a namespace, created on first use.  The
+    // returned object lives as long as the CasterStats.
+    NamespaceStats& forNamespace(const QString& ns);
+
+    // Count a dropped frame.  The namespace is the UTF-8 one from
+    // the wire, which the peer controls, so only the first
+    // MAX_DROPPED_NAMESPACES are tracked separately and the rest are
+    // counted under OTHER_DROPPED.
+    void countDropped(const QByteArray& ns, uint64_t bytes);
+    static const int MAX_DROPPED_NAMESPACES = 32;
+    static const QString OTHER_DROPPED;
+
+    Q_INVOKABLE QStringList namespaces() const;
+    // Counters and request latency percentiles (in microseconds)
+    Q_INVOKABLE QVariantMap namespaceStats(const QString& ns) const;
+    Q_INVOKABLE double latencyPercentile(const QString& ns,
+                                         double percent) const;
+    Q_INVOKABLE void reset();
+
+private:
+    mutable QMutex mutex_;
+    QHash<QString,std::shared_ptr<NamespaceStats>> namespaces_;
+    QHash<QByteArray,DropStats> dropped_;
+};
+
+}
@@ -19,36 +19,128 @@
 #include "caster.h"
 #include "channel.h"
 #include "heartbeat-interface.h"
+#include "interface.h"
+#include "interface-registry.h"
 #include "receiver-interface.h"
+#include "wire-format.h"
 
-#include <QtEndian>
 #include <QDebug>
 
+#include <algorithm>
+#include <cstring>
+
 namespace cast {
 
+namespace {
+
+void setRouteKey(std::string& key, ByteView remote, ByteView local) {
+    key.assign(remote.data(), remote.size());
+    key.push_back('\0');
+    key.append(local.data(), local.size());
+}
+
+void appendRouteNamespace(std::string& key, ByteView ns) {
+    key.push_back('\0');
+    key.append(ns.data(), ns.size());
+}
+
+QString toQString(ByteView data) {
+    return QString::fromUtf8(data.data(), data.size());
+}
+
+}
+
 Caster::Caster(QObject *parent) : QObject(parent) {
-    socket_.setPeerVerifyMode(QSslSocket::VerifyNone);
-    connect(&socket_, &QSslSocket::encrypted,
+    createConnection(false);
+}
+
+Caster::~Caster() {
+    destroyConnection();
+}
+
+void Caster::createConnection(bool threaded) {
+    if (threaded) {
+        io_thread_ = new QThread(this);
+        connection_ = new Connection(&filter_);
+        connection_->moveToThread(io_thread_);
+        connect(io_thread_, &QThread::finished,
+                connection_, &QObject::deleteLater);
+        io_thread_->start();
+    } else {
+        connection_ = new Connection(&filter_, this);
+    }
+    QMetaObject::invokeMethod(connection_, "setMaxFrameSize",
+                              Q_ARG(int, max_frame_size_));
+
+    connect(connection_, &Connection::encrypted,
             this, &Caster::onEncrypted);
-    connect(&socket_, &QIODevice::readyRead,
-            this, &Caster::onReadyRead);
-    connect(&socket_, &QIODevice::readChannelFinished,
+    connect(connection_, &Connection::messagesAvailable,
+            this, &Caster::onMessagesAvailable);
+    connect(connection_, &Connection::finished,
             this, &Caster::onReadChannelFinished);
+    connect(connection_, &Connection::bytesWritten,
+            this, &Caster::checkWatermarks);
+    connect(connection_, &Connection::bufferSizeChanged,
+            this, &Caster::bufferSizeChanged);
 }
 
-Caster::~Caster() = default;
+void Caster::destroyConnection() {
+    if (io_thread_) {
+        // The connection is deleted when the thread finishes
+        io_thread_->quit();
+        io_thread_->wait();
+        delete io_thread_;
+        io_thread_ = nullptr;
+    } else {
+        delete connection_;
+    }
+    connection_ = nullptr;
+}
+
+void Caster::setThreaded(bool threaded) {
+    if (threaded == this->threaded()) return;
+    if (connection_->isConnected()) {
+        qWarning() << "Can not change threading mode while connected";
+        return;
+    }
+    destroyConnection();
+    createConnection(threaded);
+    Q_EMIT threadedChanged();
+}
 
 void Caster::connectToHost(const QString &host_name, int port) {
-    socket_.connectToHostEncrypted(host_name, port);
+    // Anything queued on the old connection is gone, so release any
+    // backpressure that was applied.
+    if (above_high_watermark_) {
+        above_high_watermark_ = false;
+        Q_EMIT lowWatermarkReached();
+    }
+    QMetaObject::invokeMethod(connection_, "connectToHost",
+                              Q_ARG(QString, host_name), Q_ARG(int, port));
 }
 
-void Caster::onEncrypted() {
-    qInfo() << "Connected";
+void Caster::onEncrypted(bool resumed, qint64 handshake_msecs) {
+    qInfo() << "Connected" << (resumed ? "(resumed session)" : "")
+            << "handshake took" << handshake_msecs << "ms";
+    session_resumed_ = resumed;
+    handshake_time_ = handshake_msecs;
+    Q_EMIT handshakeCompleted(resumed, handshake_msecs);
     platform_channel_ = createChannel(QStringLiteral("sender-0"),
                                       QStringLiteral("receiver-0"));
-    platform_channel_->addInterface(HeartbeatInterface::URN);
-    receiver_ = static_cast<ReceiverInterface*>(
+    heartbeat_ = qobject_cast<HeartbeatInterface*>(
+        platform_channel_->addInterface(HeartbeatInterface::URN));
+    receiver_ = qobject_cast<ReceiverInterface*>(
         platform_channel_->addInterface(ReceiverInterface::URN));
+    if (!heartbeat_ || !receiver_) {
+        qWarning() << "Platform channel interfaces have the wrong type";
+        disconnectFromHost();
+        return;
+    }
+    heartbeat_->setMaxMissedPongs(max_missed_pongs_);
+    connect(heartbeat_, &HeartbeatInterface::rttChanged,
+            this, &Caster::rttChanged);
+    connect(heartbeat_, &HeartbeatInterface::peerUnresponsive,
+            this, &Caster::peerUnresponsive);
     Q_EMIT receiverChanged();
     Q_EMIT connected();
 }
@@ -57,124 +149,286 @@ void Caster::disconnectFromHost() {
     qInfo() << "Disconnecting";
     // Kill off all the channels
     platform_channel_ = nullptr;
+    const bool had_rtt = rtt() != -1;
+    heartbeat_ = nullptr;
     receiver_ = nullptr;
     Q_EMIT receiverChanged();
+    if (had_rtt) {
+        Q_EMIT rttChanged();
+    }
     for (auto it = channels_.begin(); it != channels_.end(); ++it) {
-        it->second->deleteLater();
+        // Close the channel so its routes go with it, without the
+        // queued onChannelClosed() touching it after deletion
+        Channel *channel = it->second;
+        disconnect(channel, &Channel::closed,
+                   this, &Caster::onChannelClosed);
+        channel->close();
+        channel->deleteLater();
     }
     channels_.clear();
+    routes_.clear();
+    broadcast_routes_.clear();
+    filter_.clear();
     // And disconnect the socket
-    socket_.disconnectFromHost();
+    QMetaObject::invokeMethod(connection_, "disconnectFromHost");
     Q_EMIT disconnected();
 }
 
-void Caster::onReadyRead() {
-    while (true) {
-        switch (read_state_) {
-        case State::read_header: {
-            if (socket_.bytesAvailable() < 4) {
-                /* We haven't read enough information to know the
-                 * message size, so wait for more. */
-                return;
-            }
-            char header[4];
-            socket_.read(header, sizeof(header));
-            message_size_ = qFromBigEndian<uint32_t>(
-                reinterpret_cast<const unsigned char *>(header));
-            if (message_size_ > 0) {
-                read_state_ = State::read_body;
-                message_read_ = 0;
-                message_data_.resize(message_size_);
-            }
-            break;
-        }
-        case State::read_body: {
-            auto n_read = socket_.read(message_data_.data() + message_read_,
-                                       message_size_ - message_read_);
-            if (n_read <= 0) {
-                return;
-            }
-            message_read_ += n_read;
-            /* Do we have an entire message? */
-            if (message_read_ == message_size_) {
-                if (received_message_.ParseFromArray(
-                        message_data_.constData(), message_data_.size())) {
-                    handleMessage(received_message_);
-                } else {
-                    qWarning() << "Could not parse incoming message";
-                }
-                read_state_ = State::read_header;
-                message_size_ = 0;
-                message_read_ = 0;
-            }
-            break;
-        }
-        }
+int Caster::rtt() const {
+    return heartbeat_ ? heartbeat_->rtt() : -1;
+}
+
+void Caster::setMaxMissedPongs(int max_missed_pongs) {
+    max_missed_pongs_ = max_missed_pongs;
+    if (heartbeat_) {
+        heartbeat_->setMaxMissedPongs(max_missed_pongs);
+    }
+}
+
+void Caster::setMaxFrameSize(int max_frame_size) {
+    max_frame_size = std::max(max_frame_size, 0);
+    if (max_frame_size == max_frame_size_) return;
+    max_frame_size_ = max_frame_size;
+    QMetaObject::invokeMethod(connection_, "setMaxFrameSize",
+                              Q_ARG(int, max_frame_size_));
+    Q_EMIT maxFrameSizeChanged();
+}
+
+void Caster::onMessagesAvailable() {
+    connection_->beginDrain();
+    auto& events = connection_->events();
+    while (Connection::Event *event = events.front()) {
+        received_at_ = event->queued_at;
+        handleMessage(event->message);
+
+        const qint64 latency =
+            connection_->clock().nsecsElapsed() - event->queued_at;
+        latency_last_ = latency;
+        latency_max_ = std::max(latency_max_, latency);
+        latency_total_ += latency;
+        ++latency_count_;
+        connection_->popEvent();
     }
 }
 
+QVariantMap Caster::dispatchLatency() const {
+    QVariantMap result;
+    result[QStringLiteral("last")] = latency_last_ / 1000.0;
+    result[QStringLiteral("max")] = latency_max_ / 1000.0;
+    result[QStringLiteral("mean")] = latency_count_ == 0 ? 0.0 :
+        latency_total_ / 1000.0 / latency_count_;
+    result[QStringLiteral("count")] = latency_count_;
+    return result;
+}
+
 void Caster::onReadChannelFinished() {
     disconnectFromHost();
 }
 
 Channel* Caster::createChannel(const QString& source_id,
                                const QString& destination_id) {
-    Channel *channel;
-    try {
-        channel = channels_.at({destination_id, source_id});
-    } catch (const std::out_of_range &) {
-        channel = new Channel(this, source_id, destination_id);
-        channels_.emplace(std::make_pair(destination_id, source_id), channel);
-        connect(channel, &Channel::closed,
-                this, &Caster::onChannelClosed, Qt::QueuedConnection);
+    std::string key;
+    setRouteKey(key, destination_id.toStdString(), source_id.toStdString());
+    auto it = channels_.find(key);
+    if (it != channels_.end()) {
+        return it->second;
     }
+    Channel *channel = new Channel(this, source_id, destination_id);
+    channels_.emplace(std::move(key), channel);
+    connect(channel, &Channel::closed,
+            this, &Caster::onChannelClosed, Qt::QueuedConnection);
     return channel;
 }
 
 void Caster::onChannelClosed() {
     Channel *c = static_cast<Channel*>(sender());
 
-    channels_.erase({c->destination_id_, c->source_id_});
+    setRouteKey(route_key_, c->destination_key_, c->source_key_);
+    auto it = channels_.find(route_key_);
+    if (it != channels_.end() && it->second == c) {
+        channels_.erase(it);
+    }
     if (c == platform_channel_) {
         disconnectFromHost();
     }
     c->deleteLater();
 }
 
+void Caster::addRoute(Channel *channel, const QString& ns, Interface *iface) {
+    const std::string ns_key = ns.toStdString();
+    std::string key;
+    setRouteKey(key, channel->destination_key_, channel->source_key_);
+    appendRouteNamespace(key, ns_key);
+    routes_[std::move(key)] = iface;
+    filter_.subscribe(ns);
+
+    setRouteKey(key, channel->destination_key_, ns_key);
+    broadcast_routes_[key].push_back(iface);
+}
+
+void Caster::removeRoute(Channel *channel, const QString& ns) {
+    const std::string ns_key = ns.toStdString();
+    setRouteKey(route_key_, channel->destination_key_, channel->source_key_);
+    appendRouteNamespace(route_key_, ns_key);
+    auto it = routes_.find(route_key_);
+    if (it == routes_.end()) return;
+    Interface *iface = it->second;
+    routes_.erase(it);
+    filter_.unsubscribe(ns);
+
+    setRouteKey(route_key_, channel->destination_key_, ns_key);
+    auto bit = broadcast_routes_.find(route_key_);
+    if (bit != broadcast_routes_.end()) {
+        auto& subscribers = bit->second;
+        subscribers.erase(
+            std::remove(subscribers.begin(), subscribers.end(), iface),
+            subscribers.end());
+        if (subscribers.empty()) {
+            broadcast_routes_.erase(bit);
+        }
+    }
+}
+
 void Caster::handleMessage(const Message& message) {
     if (message.protocol_version() != Caster::Message::CASTV2_1_0) {
         qWarning() << "Unsupported protocol version:" << message.protocol_version();
         return;
     }
 
-    const QString source = QString::fromStdString(message.source_id());
-    const QString destination = QString::fromStdString(message.destination_id());
-    if (destination == "*") {
+    if (message.destination_id() == "*") {
         // Broadcast message to all channels connected to the sender
-        for (auto it = channels_.lower_bound({source, QString()}); it != channels_.end(); ++it) {
-            if (it->first.first != destination) break;
-            it->second->handleMessage(message);
+        setRouteKey(route_key_, message.source_id(), message.namespace_());
+        auto it = broadcast_routes_.find(route_key_);
+        if (it == broadcast_routes_.end()) {
+            if (!InterfaceRegistry::instance().isLazy(message.namespace_())) {
+                return;
+            }
+            addLazyInterfaces(message.source_id(),
+                              toQString(message.namespace_()));
+            it = broadcast_routes_.find(route_key_);
+            if (it == broadcast_routes_.end()) return;
+        }
+        // Take a copy, since handlers may close channels
+        broadcast_targets_ = it->second;
+        for (Interface *iface : broadcast_targets_) {
+            iface->handleMessage(message);
         }
+        broadcast_targets_.clear();
+        return;
+    }
+
+    setRouteKey(route_key_, message.source_id(), message.destination_id());
+    const auto channel_key_size = route_key_.size();
+    appendRouteNamespace(route_key_, message.namespace_());
+    auto it = routes_.find(route_key_);
+    if (it != routes_.end()) {
+        it->second->handleMessage(message);
+        return;
+    }
+
+    route_key_.resize(channel_key_size);
+    auto channel = channels_.find(route_key_);
+    if (channel != channels_.end()) {
+        if (!channel->second->closed_ &&
+            InterfaceRegistry::instance().isLazy(message.namespace_())) {
+            Interface *iface = channel->second->addInterface(
+                toQString(message.namespace_()));
+            if (iface) {
+                iface->handleMessage(message);
+            }
+            return;
+        }
+        qWarning() << "Message received for unknown namespace:"
+                   << toQString(message.namespace_());
     } else {
-        try {
-            channels_.at({source, destination})->handleMessage(message);
-        } catch (const std::out_of_range &) {
-            qWarning() << "Message received for unknown channel:"
-                       << source << "->" << destination;
+        qWarning() << "Message received for unknown channel:"
+                   << toQString(message.source_id()) << "->"
+                   << toQString(message.destination_id());
+    }
+}
+
+void Caster::addLazyInterfaces(ByteView remote, const QString& ns) {
+    for (const auto& entry : channels_) {
+        Channel *channel = entry.second;
+        if (!channel->closed_ && ByteView(channel->destination_key_) == remote) {
+            channel->addInterface(ns);
         }
     }
 }
 
 bool Caster::sendMessage(const Message& message) {
-    int msg_size = message.ByteSize();
-    QByteArray data;
-    data.resize(msg_size + 4);
-    qToBigEndian<uint32_t>(msg_size,
-                           reinterpret_cast<unsigned char*>(data.data()));
-    if (!message.SerializeToArray(data.data() + 4, msg_size)) {
-        return false;
-    }
-    return socket_.write(data) == data.size();
+    const int msg_size = message.byteSize();
+    const bool queued = connection_->queueFrame(msg_size, [&](char *body) {
+            message.serializeTo(body);
+            return true;
+        });
+    if (queued) {
+        checkWatermarks();
+    }
+    return queued;
+}
+
+bool Caster::sendEncoded(const QByteArray& envelope,
+                         Message::PayloadType payload_type,
+                         const char *payload, int payload_size) {
+    const wire::Field payload_field = payload_type == Message::BINARY ?
+        wire::Field::payload_binary : wire::Field::payload_utf8;
+    const int msg_size = envelope.size()
+        + wire::tagSize(wire::Field::payload_type)
+        + wire::varintSize(payload_type)
+        + wire::tagSize(payload_field)
+        + wire::varintSize(payload_size)
+        + payload_size;
+
+    const bool queued = connection_->queueFrame(msg_size, [&](char *out) {
+            memcpy(out, envelope.constData(), envelope.size());
+            out += envelope.size();
+            out = wire::writeTag(out, wire::Field::payload_type,
+                                 wire::WireType::varint);
+            out = wire::writeVarint(out, payload_type);
+            out = wire::writeTag(out, payload_field,
+                                 wire::WireType::length_delimited);
+            out = wire::writeVarint(out, payload_size);
+            memcpy(out, payload, payload_size);
+            return true;
+        });
+    if (queued) {
+        checkWatermarks();
+    }
+    return queued;
+}
+
+qint64 Caster::bytesQueued() const {
+    return connection_->bytesQueued();
+}
+
+void Caster::setHighWatermark(int high_watermark) {
+    if (high_watermark == high_watermark_) return;
+    high_watermark_ = high_watermark;
+    Q_EMIT highWatermarkChanged();
+    checkWatermarks();
+}
+
+void Caster::setLowWatermark(int low_watermark) {
+    if (low_watermark == low_watermark_) return;
+    low_watermark_ = low_watermark;
+    Q_EMIT lowWatermarkChanged();
+    checkWatermarks();
+}
+
+void Caster::checkWatermarks() {
+    const qint64 queued = bytesQueued();
+    if (queued != last_bytes_queued_) {
+        last_bytes_queued_ = queued;
+        Q_EMIT bytesQueuedChanged();
+    }
+    if (!above_high_watermark_ && queued >= high_watermark_) {
+        above_high_watermark_ = true;
+        Q_EMIT highWatermarkReached();
+    } else if (above_high_watermark_ && queued <= low_watermark_) {
+        above_high_watermark_ = false;
+        Q_EMIT lowWatermarkReached();
+    }
 }
 
 }
@@ -18,25 +18,42 @@
 
 #pragma once
 
-#include "cast_channel.pb.h"
+#include "caster-stats.h"
+#include "connection.h"
+#include "namespace-filter.h"
 
 #include <QObject>
-#include <QSslSocket>
+#include <QThread>
+#include <QVariantMap>
 
 #include <cstdint>
-#include <map>
-#include <utility>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace cast {
 
 class Channel;
+class HeartbeatInterface;
+class Interface;
 class ReceiverInterface;
 
 class Caster : public QObject {
     Q_OBJECT
     Q_PROPERTY(cast::ReceiverInterface* receiver READ receiver NOTIFY receiverChanged)
+    Q_PROPERTY(int maxFrameSize READ maxFrameSize WRITE setMaxFrameSize NOTIFY maxFrameSizeChanged)
+    Q_PROPERTY(int bufferSize READ bufferSize NOTIFY bufferSizeChanged)
+    Q_PROPERTY(qint64 bytesQueued READ bytesQueued NOTIFY bytesQueuedChanged)
+    Q_PROPERTY(int highWatermark READ highWatermark WRITE setHighWatermark NOTIFY highWatermarkChanged)
+    Q_PROPERTY(int lowWatermark READ lowWatermark WRITE setLowWatermark NOTIFY lowWatermarkChanged)
+    Q_PROPERTY(bool threaded READ threaded WRITE setThreaded NOTIFY threadedChanged)
+    Q_PROPERTY(bool sessionResumed READ sessionResumed NOTIFY handshakeCompleted)
+    Q_PROPERTY(qint64 handshakeTime READ handshakeTime NOTIFY handshakeCompleted)
+    Q_PROPERTY(int rtt READ rtt NOTIFY rttChanged)
+    Q_PROPERTY(int maxMissedPongs READ maxMissedPongs WRITE setMaxMissedPongs)
+    Q_PROPERTY(cast::CasterStats* stats READ stats CONSTANT)
 public:
-    typedef extensions::api::cast_channel::CastMessage Message;
+    typedef Connection::Message Message;
 
     explicit Caster(QObject *parent=nullptr);
     virtual ~Caster();
@@ -47,39 +64,133 @@ public:
     Q_INVOKABLE cast::Channel* createChannel(const QString& source_id,
                                              const QString& destination_id);
 
+    // The platform receiver interface, while connected
+    cast::ReceiverInterface* receiver() const { return receiver_; }
+    // Per-namespace traffic and latency statistics
+    cast::CasterStats* stats() { return &stats_; }
+
     bool sendMessage(const Message& message);
+    // Send a message whose fields up to the payload type have already
+    // been encoded in envelope, followed by the given payload.
+    bool sendEncoded(const QByteArray& envelope,
+                     Message::PayloadType payload_type,
+                     const char *payload, int payload_size);
+
+    // Bytes accepted by sendMessage() that have not yet been written
+    // to the network.
+    qint64 bytesQueued() const;
+
+    // Time messages spent waiting between being decoded and being
+    // dispatched, in microseconds: "last", "max", "mean" and "count".
+    Q_INVOKABLE QVariantMap dispatchLatency() const;
+
+    // Nanoseconds on the connection's clock, for timing messages
+    // from when they are read rather than when they are dispatched
+    qint64 clockNsecs() const { return connection_->clock().nsecsElapsed(); }
+    // When the message being dispatched was read, on the same clock
+    qint64 receivedAt() const { return received_at_; }
 
 Q_SIGNALS:
     void connected();
     void disconnected();
 
     void receiverChanged();
+    void bufferSizeChanged();
+    void bytesQueuedChanged();
+    void maxFrameSizeChanged();
+    void highWatermarkChanged();
+    void lowWatermarkChanged();
+    void threadedChanged();
+
+    // Emitted when the TLS handshake completes.  Resumption is not
+    // detected on TLS 1.3, where resumed is always false.
+    void handshakeCompleted(bool resumed, qint64 handshake_msecs);
+
+    // Heartbeat round trip time changes, and the device failing to
+    // answer maxMissedPongs heartbeats in a row
+    void rttChanged();
+    void peerUnresponsive();
+
+    // Emitted when bytesQueued rises to highWatermark, and when it
+    // subsequently drains back down to lowWatermark.
+    void highWatermarkReached();
+    void lowWatermarkReached();
 
 private Q_SLOTS:
-    void onEncrypted();
-    void onReadyRead();
+    void onEncrypted(bool resumed, qint64 handshake_msecs);
+    void onMessagesAvailable();
     void onReadChannelFinished();
 
     void onChannelClosed();
 
 private:
     void handleMessage(const Message& message);
-    cast::ReceiverInterface* receiver() const { return receiver_; }
-
-    QSslSocket socket_;
-
-    // Manage reading the incoming message
-    enum class State { read_header, read_body };
-    State read_state_ = State::read_header;
-    uint32_t message_size_ = 0;
-    uint32_t message_read_ = 0;
-    QByteArray message_data_;
-    Message received_message_;
-
-    // Manage communication channels
-    std::map<std::pair<QString,QString>,Channel*> channels_;
+    void addRoute(Channel *channel, const QString& ns, Interface *iface);
+    void removeRoute(Channel *channel, const QString& ns);
+    // Create interfaces for a lazily registered namespace on the
+    // channels to the given remote
+    void addLazyInterfaces(ByteView remote, const QString& ns);
+    int maxFrameSize() const { return max_frame_size_; }
+    void setMaxFrameSize(int max_frame_size);
+    int bufferSize() const { return connection_->bufferSize(); }
+    int highWatermark() const { return high_watermark_; }
+    void setHighWatermark(int high_watermark);
+    int lowWatermark() const { return low_watermark_; }
+    void setLowWatermark(int low_watermark);
+    void checkWatermarks();
+    bool sessionResumed() const { return session_resumed_; }
+    qint64 handshakeTime() const { return handshake_time_; }
+    int rtt() const;
+    int maxMissedPongs() const { return max_missed_pongs_; }
+    void setMaxMissedPongs(int max_missed_pongs);
+    bool threaded() const { return io_thread_ != nullptr; }
+    void setThreaded(bool threaded);
+    void createConnection(bool threaded);
+    void destroyConnection();
+
+    // The connection, and the I/O thread it runs in when threaded
+    Connection *connection_ = nullptr;
+    QThread *io_thread_ = nullptr;
+    int max_frame_size_ = 65536;
+    bool session_resumed_ = false;
+    qint64 handshake_time_ = 0;
+    int max_missed_pongs_ = 3;
+
+    CasterStats stats_{this};
+    // Namespaces with an interface, consulted by the connection
+    NamespaceFilter filter_{stats_};
+
+    // Dispatch latency of decoded messages, in nanoseconds
+    qint64 received_at_ = 0;
+    qint64 latency_last_ = 0;
+    qint64 latency_max_ = 0;
+    qint64 latency_total_ = 0;
+    quint64 latency_count_ = 0;
+
+    // Manage writing outgoing messages
+    int high_watermark_ = 256 * 1024;
+    int low_watermark_ = 64 * 1024;
+    bool above_high_watermark_ = false;
+    qint64 last_bytes_queued_ = 0;
+
+    // Manage communication channels.  Channels are keyed on
+    // "remote\0local", and the dispatch index on
+    // "remote\0local\0namespace", using the UTF-8 ids as they appear
+    // on the wire.
+    std::unordered_map<std::string,Channel*> channels_;
+    std::unordered_map<std::string,Interface*> routes_;
+    // Broadcast index, keyed on "remote\0namespace", listing the
+    // interfaces that receive messages sent to "*" by that remote.
+    std::unordered_map<std::string,std::vector<Interface*>> broadcast_routes_;
+    // Scratch space for building lookup keys and fanning out broadcasts
+    std::string route_key_;
+    std::vector<Interface*> broadcast_targets_;
     Channel *platform_channel_ = nullptr;
+    HeartbeatInterface *heartbeat_ = nullptr;
     ReceiverInterface *receiver_ = nullptr;
+
+    friend class Channel;
+    friend class CasterRoutingTest;
 };
 
 }
@@ -17,52 +17,56 @@
 */
 
 #include "channel.h"
-#include "interface.h"
 #include "connection-interface.h"
-#include "heartbeat-interface.h"
-#include "receiver-interface.h"
-#include "media-interface.h"
+#include "interface.h"
+#include "interface-registry.h"
 
 namespace cast {
 
 Channel::Channel(Caster *caster, const QString& source_id,
                  const QString& destination_id)
     : QObject(caster), source_id_(source_id),
-      destination_id_(destination_id) {
+      destination_id_(destination_id),
+      source_key_(source_id.toStdString()),
+      destination_key_(destination_id.toStdString()) {
     addInterface(ConnectionInterface::URN);
 }
 
 Channel::~Channel() = default;
 
 cast::Interface* Channel::addInterface(const QString& ns) {
-    Interface *iface;
-
-    try {
-        iface = interfaces_.at(ns);
-    } catch (const std::out_of_range &) {
-        // TODO: add some kind of registration system
-        if (ns == ConnectionInterface::URN) {
-            iface = new ConnectionInterface(this);
-        } else if (ns == HeartbeatInterface::URN) {
-            iface = new HeartbeatInterface(this);
-        } else if (ns == ReceiverInterface::URN) {
-            iface = new ReceiverInterface(this);
-        } else if (ns == MediaInterface::URN) {
-            iface = new MediaInterface(this);
-        } else {
-            iface = new Interface(this, ns);
-        }
-        interfaces_.emplace(ns, iface);
+    Interface *iface = interfaces_.value(ns);
+    if (iface) {
+        return iface;
     }
+    // The routes of a closed channel have been removed for good
+    if (closed_) return nullptr;
+
+    iface = InterfaceRegistry::instance().create(this, ns);
+    if (!iface) return nullptr;
+    interfaces_.insert(ns, iface);
+    caster().addRoute(this, ns, iface);
+    // Don't leave a route to an interface deleted by someone else
+    connect(iface, &QObject::destroyed, this, [this, ns, iface]() {
+            if (interfaces_.value(ns) != iface) return;
+            interfaces_.remove(ns);
+            caster().removeRoute(this, ns);
+        });
+    Q_EMIT interfaceAdded(iface);
     return iface;
 }
 
+cast::Interface* Channel::findInterface(const QString& ns) const {
+    return interfaces_.value(ns);
+}
+
 void Channel::close() {
     if (closed_) return;
     closed_ = true;
 
     for (auto it = interfaces_.begin(); it != interfaces_.end(); ++it) {
-        it->second->deleteLater();
+        caster().removeRoute(this, it.key());
+        it.value()->deleteLater();
     }
     interfaces_.clear();
 
@@ -77,14 +81,4 @@ const Caster& Channel::caster() const {
     return *static_cast<const Caster*>(parent());
 }
 
-void Channel::handleMessage(const Caster::Message& message) {
-    const QString ns = QString::fromStdString(message.namespace_());
-    try {
-        interfaces_.at(ns)->handleMessage(message);
-    } catch (const std::out_of_range &) {
-        qWarning() << "Message received for unknown namespace:"
-                   << QString::fromStdString(message.namespace_());
-    }
-}
-
 }
@@ -20,9 +20,12 @@
 
 #include "caster.h"
 
+#include <QHash>
 #include <QObject>
 #include <QString>
 
+#include <string>
+
 namespace cast {
 
 class Interface;
@@ -36,24 +39,33 @@ public:
             const QString& destination_id);
     virtual ~Channel();
 
+    // The interface for a namespace, created if needed.  Returns
+    // nullptr once the channel is closed.
     Q_INVOKABLE cast::Interface* addInterface(const QString& namespace_);
+    // The interface for a namespace, if it has been added
+    Q_INVOKABLE cast::Interface* findInterface(const QString& namespace_) const;
     Q_INVOKABLE void close();
 
 Q_SIGNALS:
     void closed();
+    // Emitted when an interface is added, including interfaces for
+    // lazily registered namespaces created on their first message
+    void interfaceAdded(cast::Interface *iface);
 
 private:
     Caster& caster();
     const Caster& caster() const;
-    void handleMessage(const Caster::Message& message);
     const QString& sourceId() const { return source_id_; }
     const QString& destinationId() const { return destination_id_; }
 
     const QString source_id_;
     const QString destination_id_;
+    // The ids as UTF-8, for routing incoming messages
+    const std::string source_key_;
+    const std::string destination_key_;
 
     bool closed_ = false;
-    std::map<QString,Interface*> interfaces_;
+    QHash<QString,Interface*> interfaces_;
 
     friend class Caster;
     friend class Interface;
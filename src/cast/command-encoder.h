@@ -0,0 +1,119 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QString>
+#include <QVarLengthArray>
+
+#include <cstring>
+
+namespace cast {
+
+/* CommandEncoder writes the compact JSON for fixed shape commands
+ * such as PLAY or GET_STATUS straight into a stack buffer.  Keys are
+ * string literals whose lengths are known at compile time, so only
+ * the values need formatting:
+ *
+ *     CommandEncoder command("PAUSE");
+ *     command.add("mediaSessionId", media_session_id);
+ *     return requests_.send(command);
+ *
+ * The object is completed by finish(), which appends the requestId.
+ */
+class CommandEncoder {
+public:
+    template<int N>
+    explicit CommandEncoder(const char (&type)[N]) {
+        appendLiteral("{\"type\":\"");
+        appendLiteral(type);
+        buffer_.append('"');
+    }
+
+    template<int N>
+    CommandEncoder& add(const char (&key)[N], qint64 value) {
+        appendKey(key);
+        appendInteger(value);
+        return *this;
+    }
+
+    template<int N>
+    CommandEncoder& add(const char (&key)[N], const QString& value) {
+        appendKey(key);
+        appendString(value);
+        return *this;
+    }
+
+    // Close the object, adding the request id
+    void finish(int request_id) {
+        appendKey("requestId");
+        appendInteger(request_id);
+        buffer_.append('}');
+    }
+
+    const char *data() const { return buffer_.constData(); }
+    int size() const { return buffer_.size(); }
+
+private:
+    template<int N>
+    void appendLiteral(const char (&literal)[N]) {
+        buffer_.append(literal, N - 1);
+    }
+
+    template<int N>
+    void appendKey(const char (&key)[N]) {
+        appendLiteral(",\"");
+        appendLiteral(key);
+        appendLiteral("\":");
+    }
+
+    void appendInteger(qint64 value) {
+        char digits[20];
+        int n = 0;
+        quint64 magnitude = value < 0 ? 0 - quint64(value) : quint64(value);
+        do {
+            digits[n++] = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (value < 0) buffer_.append('-');
+        while (n > 0) buffer_.append(digits[--n]);
+    }
+
+    void appendString(const QString& value) {
+        static const char hex[] = "0123456789abcdef";
+        const QByteArray utf8 = value.toUtf8();
+        buffer_.append('"');
+        for (const char c : utf8) {
+            if (c == '"' || c == '\\') {
+                buffer_.append('\\');
+                buffer_.append(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                appendLiteral("\\u00");
+                buffer_.append(hex[c >> 4]);
+                buffer_.append(hex[c & 0xf]);
+            } else {
+                buffer_.append(c);
+            }
+        }
+        buffer_.append('"');
+    }
+
+    QVarLengthArray<char, 128> buffer_;
+};
+
+}
@@ -18,10 +18,9 @@
 
 #include "connection-interface.h"
 #include "channel.h"
+#include "json-peek.h"
 
 #include <QDebug>
-#include <QJsonDocument>
-#include <QJsonObject>
 
 namespace cast {
 
@@ -29,27 +28,19 @@ const QString ConnectionInterface::URN = QStringLiteral("urn:x-cast:com.google.c
 
 ConnectionInterface::ConnectionInterface(Channel *channel)
     : Interface(channel, URN) {
-    connect(this, &Interface::messageReceived,
-            this, &ConnectionInterface::onMessageReceived);
     send(R"({"type": "CONNECT"})");
 }
 
 ConnectionInterface::~ConnectionInterface() = default;
 
-void ConnectionInterface::onMessageReceived(const QString& data) {
-    QJsonParseError err;
-    auto doc = QJsonDocument::fromJson(data.toUtf8(), &err);
-    if (err.error != QJsonParseError::NoError) {
-        qWarning() << "Could not parse message on connection channel:"
-                   << err.errorString();
-        return;
-    }
-    if (doc.object()["type"].toString() == "CLOSE") {
+void ConnectionInterface::handleUtf8(const QByteArray& data) {
+    if (json::peekString(data, QLatin1String("type")) == QLatin1String("CLOSE")) {
 #if 0
         qWarning() << "Received close message from channel";
 #endif
         channel().close();
     }
+    Interface::handleUtf8(data);
 }
 
 }
@@ -30,8 +30,8 @@ public:
 
     static const QString URN;
 
-private Q_SLOTS:
-    void onMessageReceived(const QString& data);
+protected:
+    void handleUtf8(const QByteArray& data) override;
 };
 
 }
@@ -0,0 +1,281 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "connection.h"
+#include "json-peek.h"
+#include "tls-session-cache.h"
+
+#include <QDebug>
+#include <QSslConfiguration>
+
+#include <algorithm>
+
+namespace cast {
+
+namespace {
+// Maximum amount of data to hand to the socket at once.  The rest
+// stays in our own write queue, where it is visible to bytesQueued().
+const qint64 socket_write_limit = 64 * 1024;
+
+// Decoded messages waiting for the Caster.  Once either limit is
+// reached the socket is no longer read, so TCP pushes back on the
+// device, until the Caster has drained the queue to half of them.
+const qint64 event_queue_bytes = 256 * 1024;
+const int event_queue_length = 1024;
+// Frame copies larger than this are freed when their event is reused
+const size_t max_retained_frame = 4096;
+// Decrypted data the socket may buffer while reading is paused
+const qint64 socket_read_limit = 64 * 1024;
+
+const char heartbeat_urn[] = "urn:x-cast:com.google.cast.tp.heartbeat";
+const char pong_payload[] = R"({"type": "PONG"})";
+}
+
+Connection::Connection(NamespaceFilter *filter, QObject *parent)
+    : QObject(parent), socket_(this), filter_(filter) {
+    clock_.start();
+    buffer_size_.store(reader_.capacity());
+    socket_.setReadBufferSize(socket_read_limit);
+
+    socket_.setPeerVerifyMode(QSslSocket::VerifyNone);
+    connect(&socket_, &QAbstractSocket::connected,
+            this, &Connection::onConnected);
+    connect(&socket_, &QSslSocket::encrypted,
+            this, &Connection::onEncrypted);
+    connect(&socket_, &QIODevice::readyRead,
+            this, &Connection::onReadyRead);
+    connect(&socket_, &QIODevice::readChannelFinished,
+            this, &Connection::onReadChannelFinished);
+    connect(&socket_, &QSslSocket::encryptedBytesWritten,
+            this, &Connection::flush);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    // TLS 1.3 tickets arrive after the handshake has completed
+    connect(&socket_, &QSslSocket::newSessionTicketReceived,
+            this, &Connection::onNewSessionTicket);
+#endif
+}
+
+Connection::~Connection() = default;
+
+void Connection::connectToHost(const QString &host_name, int port) {
+    reader_.clear();
+    {
+        QMutexLocker lock(&write_mutex_);
+        writer_.clear();
+        bytes_queued_.store(0);
+    }
+
+    // Offer the ticket from our last session with this device, if any
+    host_name_ = host_name;
+    port_ = port;
+    offered_ticket_ = TlsSessionCache::instance().ticket(host_name, port);
+    QSslConfiguration config = socket_.sslConfiguration();
+    config.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    config.setSessionTicket(offered_ticket_);
+    socket_.setSslConfiguration(config);
+
+    socket_.connectToHostEncrypted(host_name, port);
+}
+
+void Connection::disconnectFromHost() {
+    connected_.store(false);
+    // Hand any queued messages to the socket, and disconnect it
+    {
+        QMutexLocker lock(&write_mutex_);
+        if (!writer_.isEmpty()) {
+            writer_.writeTo(socket_, writer_.size());
+            writer_.clear();
+        }
+        bytes_queued_.store(0);
+    }
+    socket_.disconnectFromHost();
+}
+
+void Connection::setMaxFrameSize(int max_frame_size) {
+    reader_.setMaxFrameSize(std::max(max_frame_size, 0));
+}
+
+void Connection::onConnected() {
+    handshake_started_ = clock_.elapsed();
+}
+
+void Connection::onEncrypted() {
+    const qint64 handshake_msecs = clock_.elapsed() - handshake_started_;
+
+    /* Qt does not say whether the session was resumed.  A device
+     * that accepts our ticket keeps using it, while a full handshake
+     * issues a new one, so treat an unchanged ticket as resumption.
+     * This under-reports devices that renew tickets on resumption,
+     * and does not work on TLS 1.3: its tickets are single use and
+     * only arrive after the handshake, so resumed is always false. */
+    const QByteArray ticket = socket_.sslConfiguration().sessionTicket();
+    bool resumed = !offered_ticket_.isEmpty() && ticket == offered_ticket_;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    if (socket_.sessionProtocol() == QSsl::TlsV1_3) {
+        resumed = false;
+    }
+#endif
+    if (!ticket.isEmpty() && ticket != offered_ticket_) {
+        TlsSessionCache::instance().setTicket(host_name_, port_, ticket);
+    }
+
+    connected_.store(true);
+    Q_EMIT encrypted(resumed, handshake_msecs);
+}
+
+void Connection::onNewSessionTicket() {
+    const QByteArray ticket = socket_.sslConfiguration().sessionTicket();
+    if (!ticket.isEmpty()) {
+        TlsSessionCache::instance().setTicket(host_name_, port_, ticket);
+    }
+}
+
+void Connection::onReadChannelFinished() {
+    connected_.store(false);
+    Q_EMIT finished();
+}
+
+void Connection::popEvent() {
+    Event *event = events_.front();
+    if (!event) return;
+    const qint64 bytes = event->frame.size();
+    events_.pop();
+    const qint64 queued_bytes = queued_bytes_.fetch_sub(bytes) - bytes;
+    const int queued_events = queued_events_.fetch_sub(1) - 1;
+    // Resume reading once the queue is down to half its limits
+    if (queued_bytes <= event_queue_bytes / 2 &&
+        queued_events <= event_queue_length / 2 &&
+        read_paused_.exchange(false)) {
+        QMetaObject::invokeMethod(this, "onReadyRead", Qt::QueuedConnection);
+    }
+}
+
+bool Connection::eventQueueFull() const {
+    return queued_bytes_.load() >= event_queue_bytes ||
+        queued_events_.load() >= event_queue_length;
+}
+
+void Connection::onReadyRead() {
+    const char *data;
+    uint32_t size;
+    bool queued = false;
+    /* Drain everything the socket has buffered, decoding each
+     * complete frame directly from the reader's buffer.  Frames
+     * already in the buffer are decoded before reading more. */
+    for (;;) {
+        if (eventQueueFull()) {
+            read_paused_.store(true);
+            // The consumer may have drained the queue in between
+            if (eventQueueFull() || !read_paused_.exchange(false)) break;
+        }
+        if (!reader_.nextFrame(data, size)) {
+            if (reader_.readFrom(socket_) <= 0) break;
+            continue;
+        }
+        // Drop frames for namespaces without an interface before
+        // copying or decoding them
+        ByteView ns;
+        if (filter_ && CastMessage::peekNamespace(data, size, ns) &&
+            !filter_->accept(ns, size)) {
+            continue;
+        }
+        Event& event = events_.prepare();
+        if (event.frame.capacity() > max_retained_frame &&
+            size <= max_retained_frame) {
+            std::string().swap(event.frame);
+        }
+        event.frame.assign(data, size);
+        if (!event.message.parse(event.frame.data(), size)) {
+            qWarning() << "Could not parse incoming message";
+            continue;
+        }
+        event.queued_at = clock_.nsecsElapsed();
+        if (answerPing(event.message)) continue;
+        queued_bytes_.fetch_add(size);
+        queued_events_.fetch_add(1);
+        events_.push();
+        queued = true;
+    }
+    if (queued && !notify_pending_.exchange(true)) {
+        Q_EMIT messagesAvailable();
+    }
+    updateBufferSize();
+}
+
+void Connection::updateBufferSize() {
+    const int size = reader_.capacity() + queued_bytes_.load() +
+        bytes_queued_.load();
+    if (size != buffer_size_.exchange(size)) {
+        Q_EMIT bufferSizeChanged();
+    }
+}
+
+bool Connection::answerPing(const Message& message) {
+    if (!(message.namespace_() == heartbeat_urn) ||
+        message.payload_type() != Message::STRING) return false;
+    const ByteView payload = message.payload_utf8();
+    const QByteArray data =
+        QByteArray::fromRawData(payload.data(), payload.size());
+    if (json::peekString(data, QLatin1String("type")) != QLatin1String("PING")) {
+        return false;
+    }
+
+    Message pong;
+    pong.set_source_id(message.destination_id());
+    pong.set_destination_id(message.source_id());
+    pong.set_namespace_(message.namespace_());
+    pong.set_payload_type(Message::STRING);
+    pong.set_payload_utf8(ByteView(pong_payload, sizeof(pong_payload) - 1));
+    queueFrame(pong.byteSize(), [&](char *body) {
+            pong.serializeTo(body);
+            return true;
+        });
+    return true;
+}
+
+void Connection::scheduleFlush() {
+    // Coalesce frames queued in the same event loop iteration
+    if (!flush_pending_.exchange(true)) {
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+void Connection::flush() {
+    flush_pending_.store(false);
+    {
+        QMutexLocker lock(&write_mutex_);
+        const qint64 room = socket_write_limit - socket_.bytesToWrite()
+            - socket_.encryptedBytesToWrite();
+        if (room > 0 && !writer_.isEmpty()) {
+            if (writer_.writeTo(socket_, room) < 0) {
+                qWarning() << "Could not write to socket:"
+                           << socket_.errorString();
+            }
+        }
+        updateBytesQueued();
+    }
+    updateBufferSize();
+    Q_EMIT bytesWritten();
+}
+
+void Connection::updateBytesQueued() {
+    bytes_queued_.store(writer_.size() + socket_.bytesToWrite()
+                        + socket_.encryptedBytesToWrite());
+}
+
+}
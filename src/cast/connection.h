@@ -0,0 +1,170 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "cast-message.h"
+#include "frame-reader.h"
+#include "frame-writer.h"
+#include "namespace-filter.h"
+#include "spsc-queue.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QSslSocket>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace cast {
+
+/* Connection owns the TLS socket to a device and handles framing and
+ * decoding of the messages sent over it.  It may live in the same
+ * thread as its Caster, or be moved to a dedicated I/O thread.
+ *
+ * Decoded messages are passed to the Caster's thread through a
+ * lock-free queue, with messagesAvailable() emitted when the queue
+ * becomes non-empty.  The queue is bounded: while it is full the
+ * socket is not read, leaving TCP to slow the device down.  Heartbeat PINGs are answered by the connection
+ * itself, so a busy Caster thread does not delay the PONG.  Outgoing frames are encoded into a shared write
+ * queue by queueFrame(), which may be called from any thread.
+ */
+class Connection : public QObject {
+    Q_OBJECT
+public:
+    typedef CastMessage Message;
+
+    struct Event {
+        // A copy of the frame, which message refers into.  Events
+        // are recycled, so the copy reuses the frame's storage.
+        std::string frame;
+        Message message;
+        // When the message was queued, according to clock()
+        qint64 queued_at = 0;
+    };
+
+    // Incoming frames are checked against filter, if given, before
+    // being decoded.
+    explicit Connection(NamespaceFilter *filter=nullptr,
+                        QObject *parent=nullptr);
+    virtual ~Connection();
+
+    // Encode a frame with a body of the given size into the write
+    // queue.  The encode function is called with a pointer to the
+    // frame body, and returns false if encoding failed.
+    template <typename Encode>
+    bool queueFrame(uint32_t size, Encode encode);
+
+    // Consumer side of the decoded message queue.  beginDrain()
+    // should be called in response to messagesAvailable(), before
+    // reading the queue.  Events are released with popEvent().
+    SpscQueue<Event>& events() { return events_; }
+    void beginDrain() { notify_pending_.store(false); }
+    void popEvent();
+
+    // A monotonic clock shared by the I/O and consumer threads
+    const QElapsedTimer& clock() const { return clock_; }
+
+    bool isConnected() const { return connected_.load(); }
+    qint64 bytesQueued() const { return bytes_queued_.load(); }
+    // Bytes held for incoming and outgoing messages: the read
+    // buffer, the decoded message queue and the write queue
+    int bufferSize() const { return buffer_size_.load(); }
+
+public Q_SLOTS:
+    void connectToHost(const QString& host_name, int port);
+    void disconnectFromHost();
+    void setMaxFrameSize(int max_frame_size);
+
+Q_SIGNALS:
+    // Emitted when the TLS handshake completes, reporting whether a
+    // cached session was resumed and how long the handshake took.
+    // resumed is always false on TLS 1.3.
+    void encrypted(bool resumed, qint64 handshake_msecs);
+    void finished();
+    void messagesAvailable();
+    void bytesWritten();
+    void bufferSizeChanged();
+
+private Q_SLOTS:
+    void onConnected();
+    void onEncrypted();
+    void onNewSessionTicket();
+    void onReadyRead();
+    void onReadChannelFinished();
+    void flush();
+
+private:
+    // Reply to a heartbeat PING.  Returns false for other messages.
+    bool answerPing(const Message& message);
+    bool eventQueueFull() const;
+    void updateBufferSize();
+    void scheduleFlush();
+    void updateBytesQueued();
+
+    QSslSocket socket_;
+    QElapsedTimer clock_;
+    std::atomic<bool> connected_{false};
+
+    // Manage TLS session resumption
+    QString host_name_;
+    int port_ = 0;
+    QByteArray offered_ticket_;
+    qint64 handshake_started_ = 0;
+
+    // Manage reading the incoming messages
+    NamespaceFilter *filter_;
+    FrameReader reader_;
+    SpscQueue<Event> events_;
+    std::atomic<bool> notify_pending_{false};
+    // Frame bytes and events in the queue, and whether reading has
+    // stopped until the consumer drains it
+    std::atomic<qint64> queued_bytes_{0};
+    std::atomic<int> queued_events_{0};
+    std::atomic<bool> read_paused_{false};
+    std::atomic<int> buffer_size_{0};
+
+    // Manage writing outgoing messages
+    QMutex write_mutex_;
+    FrameWriter writer_;
+    std::atomic<bool> flush_pending_{false};
+    std::atomic<qint64> bytes_queued_{0};
+};
+
+template <typename Encode>
+bool Connection::queueFrame(uint32_t size, Encode encode) {
+    if (!isConnected()) {
+        return false;
+    }
+    {
+        QMutexLocker lock(&write_mutex_);
+        char *body = writer_.appendFrame(size);
+        if (!encode(body)) {
+            writer_.discardFrame(size);
+            return false;
+        }
+        bytes_queued_.fetch_add(4 + size);
+    }
+    scheduleFlush();
+    return true;
+}
+
+}
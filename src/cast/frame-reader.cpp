@@ -0,0 +1,133 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "frame-reader.h"
+
+#include <QDebug>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+namespace cast {
+
+namespace {
+const int header_size = 4;
+// Number of idle reads after a large frame before the buffer shrinks
+const int shrink_after_reads = 32;
+}
+
+FrameReader::FrameReader(int initial_capacity, uint32_t max_frame_size)
+    : initial_capacity_(initial_capacity), max_frame_size_(max_frame_size) {
+    buffer_.resize(initial_capacity_);
+}
+
+FrameReader::~FrameReader() = default;
+
+void FrameReader::clear() {
+    start_ = end_ = 0;
+    skip_remaining_ = 0;
+}
+
+void FrameReader::setMaxFrameSize(uint32_t max_frame_size) {
+    max_frame_size_ = max_frame_size;
+}
+
+uint32_t FrameReader::pendingFrameSize() const {
+    return qFromBigEndian<uint32_t>(
+        reinterpret_cast<const unsigned char*>(buffer_.constData() + start_));
+}
+
+void FrameReader::makeRoom() {
+    if (start_ == end_) {
+        start_ = end_ = 0;
+        // Give back memory allocated for a burst of large frames.
+        if (buffer_.size() > initial_capacity_ &&
+            ++reads_since_large_frame_ >= shrink_after_reads) {
+            buffer_.resize(initial_capacity_);
+            buffer_.squeeze();
+            reads_since_large_frame_ = 0;
+        }
+    }
+    // Move a trailing partial frame to the front of the buffer
+    if (start_ > 0 && end_ == buffer_.size()) {
+        std::memmove(buffer_.data(), buffer_.constData() + start_,
+                     available());
+        end_ -= start_;
+        start_ = 0;
+    }
+    // If the buffer is still full, the pending frame is larger than
+    // the buffer: grow it so the whole frame fits.  Oversized frames
+    // are discarded by nextFrame() rather than buffered.
+    if (end_ == buffer_.size() && available() >= header_size) {
+        const uint32_t frame_size = pendingFrameSize();
+        if (frame_size <= max_frame_size_) {
+            const qint64 needed = std::max(qint64(buffer_.size()) * 2,
+                                           header_size + qint64(frame_size));
+            buffer_.resize(int(std::min(
+                needed, header_size + qint64(max_frame_size_))));
+            reads_since_large_frame_ = 0;
+        }
+    }
+}
+
+qint64 FrameReader::readFrom(QIODevice& device) {
+    makeRoom();
+    const qint64 n_read = device.read(buffer_.data() + end_,
+                                      buffer_.size() - end_);
+    if (n_read > 0) {
+        end_ += n_read;
+    }
+    return n_read;
+}
+
+void FrameReader::discard() {
+    const int n = int(std::min<qint64>(skip_remaining_, available()));
+    start_ += n;
+    skip_remaining_ -= n;
+}
+
+bool FrameReader::nextFrame(const char*& data, uint32_t& size) {
+    discard();
+    while (skip_remaining_ == 0 && available() >= header_size) {
+        const char *header = buffer_.constData() + start_;
+        const uint32_t frame_size = pendingFrameSize();
+        if (frame_size > max_frame_size_) {
+            qWarning() << "Skipping oversized frame of" << frame_size
+                       << "bytes";
+            ++skipped_frames_;
+            start_ += header_size;
+            skip_remaining_ = frame_size;
+            discard();
+            continue;
+        }
+        if (available() - header_size < qint64(frame_size)) {
+            return false;
+        }
+        start_ += header_size + frame_size;
+        // Zero length frames carry no message, so skip them.
+        if (frame_size == 0) continue;
+
+        data = header + header_size;
+        size = frame_size;
+        return true;
+    }
+    return false;
+}
+
+}
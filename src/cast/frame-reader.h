@@ -0,0 +1,84 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include <cstdint>
+
+namespace cast {
+
+/* FrameReader accumulates data read from a socket in a reusable
+ * buffer and splits it into length prefixed frames.  Complete frames
+ * are handed out as pointers into the buffer so they can be parsed in
+ * place.  The buffer is only compacted when a partial frame is left
+ * at its end, and only grows when a single frame will not fit.
+ *
+ * Frames larger than maxFrameSize() are never buffered: their bodies
+ * are discarded as they arrive.  After a burst of large frames, the
+ * buffer shrinks back to its initial capacity once it has been idle
+ * for a while.
+ */
+class FrameReader {
+public:
+    explicit FrameReader(int initial_capacity=4096,
+                         uint32_t max_frame_size=65536);
+    ~FrameReader();
+
+    // Read as much data from the device as will fit in the buffer.
+    // Returns the number of bytes read, or -1 on error.
+    qint64 readFrom(QIODevice& device);
+
+    // Return the next complete frame in the buffer.  The frame data
+    // remains valid until the next call to readFrom() or clear().
+    bool nextFrame(const char*& data, uint32_t& size);
+
+    void clear();
+
+    uint32_t maxFrameSize() const { return max_frame_size_; }
+    void setMaxFrameSize(uint32_t max_frame_size);
+
+    // Number of bytes currently allocated for the buffer
+    int capacity() const { return buffer_.size(); }
+    // Number of oversized frames discarded so far
+    quint64 skippedFrames() const { return skipped_frames_; }
+
+private:
+    int available() const { return end_ - start_; }
+    uint32_t pendingFrameSize() const;
+    void makeRoom();
+    void discard();
+
+    const int initial_capacity_;
+    uint32_t max_frame_size_;
+
+    QByteArray buffer_;
+    // Unconsumed data lives in the range [start_, end_)
+    int start_ = 0;
+    int end_ = 0;
+
+    // Bytes left to discard from an oversized frame
+    qint64 skip_remaining_ = 0;
+    quint64 skipped_frames_ = 0;
+    // Reads since the last frame that did not fit the initial capacity
+    int reads_since_large_frame_ = 0;
+};
+
+}
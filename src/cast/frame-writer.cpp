@@ -0,0 +1,76 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "frame-writer.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+
+namespace cast {
+
+namespace {
+const int header_size = 4;
+}
+
+FrameWriter::FrameWriter(int initial_capacity)
+    : initial_capacity_(initial_capacity) {
+    buffer_.reserve(initial_capacity_);
+}
+
+FrameWriter::~FrameWriter() = default;
+
+void FrameWriter::clear() {
+    start_ = 0;
+    buffer_.resize(0);
+    if (buffer_.capacity() > initial_capacity_) {
+        buffer_.squeeze();
+        buffer_.reserve(initial_capacity_);
+    }
+}
+
+char *FrameWriter::appendFrame(uint32_t size) {
+    // Reclaim space taken up by data that has already been written
+    if (start_ > 0 && start_ >= buffer_.size() / 2) {
+        buffer_.remove(0, start_);
+        start_ = 0;
+    }
+    const int offset = buffer_.size();
+    buffer_.resize(offset + header_size + size);
+    char *header = buffer_.data() + offset;
+    qToBigEndian<uint32_t>(size, reinterpret_cast<unsigned char*>(header));
+    return header + header_size;
+}
+
+void FrameWriter::discardFrame(uint32_t size) {
+    buffer_.resize(buffer_.size() - header_size - size);
+}
+
+qint64 FrameWriter::writeTo(QIODevice& device, qint64 max_bytes) {
+    const qint64 n_written = device.write(
+        buffer_.constData() + start_, std::min<qint64>(size(), max_bytes));
+    if (n_written > 0) {
+        start_ += n_written;
+        if (isEmpty()) {
+            clear();
+        }
+    }
+    return n_written;
+}
+
+}
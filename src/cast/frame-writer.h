@@ -0,0 +1,62 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include <cstdint>
+
+namespace cast {
+
+/* FrameWriter queues length prefixed frames for sending.  Frames are
+ * encoded directly into a single buffer, so several small messages
+ * queued in the same event loop iteration go out in one write.
+ */
+class FrameWriter {
+public:
+    explicit FrameWriter(int initial_capacity=4096);
+    ~FrameWriter();
+
+    // Append a frame header for a body of the given size, returning
+    // a pointer to where the body should be written.  The pointer is
+    // only valid until the next call on the writer.
+    char *appendFrame(uint32_t size);
+    // Drop the most recently appended frame, if its body could not
+    // be encoded.
+    void discardFrame(uint32_t size);
+
+    // Write up to max_bytes of queued data to the device.  Returns
+    // the number of bytes written, or -1 on error.
+    qint64 writeTo(QIODevice& device, qint64 max_bytes);
+
+    // Number of bytes queued but not yet written to the device
+    int size() const { return buffer_.size() - start_; }
+    bool isEmpty() const { return size() == 0; }
+
+    void clear();
+
+private:
+    const int initial_capacity_;
+    QByteArray buffer_;
+    // Offset of the first byte not yet written
+    int start_ = 0;
+};
+
+}
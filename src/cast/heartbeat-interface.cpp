@@ -17,25 +17,68 @@
 */
 
 #include "heartbeat-interface.h"
+#include "heartbeat-scheduler.h"
+#include "json-peek.h"
+
+#include <QDebug>
 
 namespace cast {
 
 const QString HeartbeatInterface::URN = QStringLiteral("urn:x-cast:com.google.cast.tp.heartbeat");
 
 HeartbeatInterface::HeartbeatInterface(Channel *channel)
-    : Interface(channel, URN) {
-    connect(&timer_, &QTimer::timeout,
-            this, &HeartbeatInterface::onTimeout);
-    timer_.setInterval(5000);
-    timer_.setSingleShot(false);
-    timer_.start();
+    : Interface(channel, URN),
+      scheduler_(&HeartbeatScheduler::forCurrentThread()) {
+    scheduler_->add(this);
+}
+
+HeartbeatInterface::~HeartbeatInterface() {
+    scheduler_->remove(this);
 }
 
-HeartbeatInterface::~HeartbeatInterface() = default;
+void HeartbeatInterface::setMaxMissedPongs(int max_missed_pongs) {
+    if (max_missed_pongs == max_missed_pongs_) return;
+    max_missed_pongs_ = max_missed_pongs;
+    Q_EMIT maxMissedPongsChanged();
+}
 
-void HeartbeatInterface::onTimeout()
-{
+void HeartbeatInterface::beat() {
+    if (awaiting_pong_) {
+        ++missed_pongs_;
+        Q_EMIT missedPongsChanged();
+        // maxMissedPongs may have been lowered below the count
+        if (missed_pongs_ >= max_missed_pongs_ && !unresponsive_) {
+            unresponsive_ = true;
+            qWarning() << "No response to" << missed_pongs_ << "heartbeats";
+            Q_EMIT peerUnresponsive();
+        }
+    }
     send(R"({"type": "PING"})");
+    // A late PONG is timed from the first PING it could answer
+    if (!awaiting_pong_) {
+        ping_sent_at_ = caster().clockNsecs();
+        awaiting_pong_ = true;
+    }
+}
+
+void HeartbeatInterface::handleUtf8(const QByteArray& data) {
+    // Heartbeats carry nothing but their type, so skip the JSON
+    // parser.  PINGs are answered by the Connection, on its thread.
+    const auto type = json::peekString(data, QLatin1String("type"));
+    if (type == QLatin1String("PONG") && awaiting_pong_) {
+        awaiting_pong_ = false;
+        // Timed to when the PONG was read, however long it then
+        // waited for this thread
+        rtt_ = (caster().receivedAt() - ping_sent_at_) / 1000000;
+        const bool had_missed = missed_pongs_ != 0;
+        missed_pongs_ = 0;
+        unresponsive_ = false;
+        Q_EMIT rttChanged();
+        if (had_missed) {
+            Q_EMIT missedPongsChanged();
+        }
+    }
+    Interface::handleUtf8(data);
 }
 
 }
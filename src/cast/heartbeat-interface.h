@@ -20,23 +20,57 @@
 
 #include "interface.h"
 
-#include <QTimer>
-
 namespace cast {
 
+class HeartbeatScheduler;
+
 class HeartbeatInterface : public Interface {
     Q_OBJECT
+    Q_PROPERTY(int rtt READ rtt NOTIFY rttChanged)
+    Q_PROPERTY(int missedPongs READ missedPongs NOTIFY missedPongsChanged)
+    Q_PROPERTY(int maxMissedPongs READ maxMissedPongs WRITE setMaxMissedPongs NOTIFY maxMissedPongsChanged)
 public:
     HeartbeatInterface(Channel *channel);
     virtual ~HeartbeatInterface();
 
     static const QString URN;
 
-private Q_SLOTS:
-    void onTimeout();
+    // Round trip time of the last answered PING, in milliseconds
+    int rtt() const { return rtt_; }
+    int missedPongs() const { return missed_pongs_; }
+    int maxMissedPongs() const { return max_missed_pongs_; }
+    void setMaxMissedPongs(int max_missed_pongs);
+
+Q_SIGNALS:
+    void rttChanged();
+    void missedPongsChanged();
+    void maxMissedPongsChanged();
+    // Emitted once maxMissedPongs PINGs in a row go unanswered
+    void peerUnresponsive();
+
+protected:
+    void handleUtf8(const QByteArray& data) override;
 
 private:
-    QTimer timer_;
+    // Called by the scheduler once per heartbeat interval
+    void beat();
+
+    // When the oldest unanswered PING was sent, on the connection's
+    // clock
+    qint64 ping_sent_at_ = 0;
+    bool awaiting_pong_ = false;
+    int rtt_ = -1;
+    int missed_pongs_ = 0;
+    int max_missed_pongs_ = 3;
+    // Set once peerUnresponsive has been emitted, until the next PONG
+    bool unresponsive_ = false;
+
+    // The scheduler this was added to, and the position in its timer
+    // wheel
+    HeartbeatScheduler *scheduler_;
+    int slot_ = -1;
+
+    friend class HeartbeatScheduler;
 };
 
 }
@@ -0,0 +1,80 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "heartbeat-scheduler.h"
+#include "heartbeat-interface.h"
+
+#include <QThreadStorage>
+
+#include <algorithm>
+
+namespace cast {
+
+namespace {
+QThreadStorage<HeartbeatScheduler*> schedulers;
+}
+
+HeartbeatScheduler& HeartbeatScheduler::forCurrentThread() {
+    if (!schedulers.hasLocalData()) {
+        schedulers.setLocalData(new HeartbeatScheduler);
+    }
+    return *schedulers.localData();
+}
+
+HeartbeatScheduler::HeartbeatScheduler()
+    : random_(std::random_device()()) {
+    connect(&timer_, &QTimer::timeout,
+            this, &HeartbeatScheduler::onTick);
+    timer_.setInterval(tick);
+    timer_.setSingleShot(false);
+}
+
+HeartbeatScheduler::~HeartbeatScheduler() = default;
+
+void HeartbeatScheduler::add(HeartbeatInterface *iface) {
+    std::uniform_int_distribution<int> offset(1, n_slots);
+    const int slot = (current_slot_ + offset(random_)) % n_slots;
+    slots_[slot].push_back(iface);
+    iface->slot_ = slot;
+    if (count_++ == 0) {
+        timer_.start();
+    }
+}
+
+void HeartbeatScheduler::remove(HeartbeatInterface *iface) {
+    if (iface->slot_ < 0) return;
+    auto& slot = slots_[iface->slot_];
+    slot.erase(std::remove(slot.begin(), slot.end(), iface), slot.end());
+    due_.erase(std::remove(due_.begin(), due_.end(), iface), due_.end());
+    iface->slot_ = -1;
+    if (--count_ == 0) {
+        timer_.stop();
+    }
+}
+
+void HeartbeatScheduler::onTick() {
+    current_slot_ = (current_slot_ + 1) % n_slots;
+    due_ = slots_[current_slot_];
+    while (!due_.empty()) {
+        HeartbeatInterface *iface = due_.back();
+        due_.pop_back();
+        iface->beat();
+    }
+}
+
+}
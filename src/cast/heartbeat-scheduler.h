@@ -0,0 +1,69 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+#include <random>
+#include <vector>
+
+namespace cast {
+
+class HeartbeatInterface;
+
+/* HeartbeatScheduler drives the heartbeats of every HeartbeatInterface
+ * in a thread from a single timer wheel.  Each interface is placed in
+ * a random slot of the wheel when it registers, so heartbeats to
+ * different devices are spread over the interval rather than sent in
+ * synchronised bursts.
+ */
+class HeartbeatScheduler : public QObject {
+    Q_OBJECT
+public:
+    // The scheduler for the calling thread, created on first use
+    static HeartbeatScheduler& forCurrentThread();
+
+    virtual ~HeartbeatScheduler();
+
+    void add(HeartbeatInterface *iface);
+    void remove(HeartbeatInterface *iface);
+
+    static const int interval = 5000;
+    static const int tick = 250;
+
+private Q_SLOTS:
+    void onTick();
+
+private:
+    HeartbeatScheduler();
+
+    static const int n_slots = interval / tick;
+
+    QTimer timer_;
+    std::vector<HeartbeatInterface*> slots_[n_slots];
+    int current_slot_ = 0;
+    int count_ = 0;
+    std::minstd_rand random_;
+    // Copy of the current slot, so interfaces can be removed while
+    // it is being processed
+    std::vector<HeartbeatInterface*> due_;
+};
+
+}
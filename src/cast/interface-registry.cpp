@@ -0,0 +1,102 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "interface-registry.h"
+#include "connection-interface.h"
+#include "heartbeat-interface.h"
+#include "interface.h"
+#include "media-interface.h"
+#include "receiver-interface.h"
+
+#include <QDebug>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace cast {
+
+InterfaceRegistry::InterfaceRegistry() {
+    registerInterface<ConnectionInterface>(ConnectionInterface::URN);
+    registerInterface<HeartbeatInterface>(HeartbeatInterface::URN);
+    registerInterface<ReceiverInterface>(ReceiverInterface::URN);
+    registerInterface<MediaInterface>(MediaInterface::URN);
+    // Caster relies on the platform channel interfaces having these
+    // types, so they are fixed from here on
+    for (auto it = entries_.constBegin(); it != entries_.constEnd(); ++it) {
+        builtins_.insert(it.key());
+    }
+}
+
+InterfaceRegistry& InterfaceRegistry::instance() {
+    static InterfaceRegistry registry;
+    return registry;
+}
+
+bool InterfaceRegistry::registerFactory(const QString& ns, Factory factory,
+                                        bool lazy) {
+    const QByteArray key = ns.toUtf8();
+    if (builtins_.contains(key)) {
+        qWarning() << "Can not replace the built in interface for" << ns;
+        return false;
+    }
+    QWriteLocker lock(&lock_);
+    entries_.insert(key, Entry{std::move(factory), lazy});
+    return true;
+}
+
+bool InterfaceRegistry::registerNamespace(const QString& ns, bool lazy) {
+    return registerFactory(ns, [ns](Channel *channel) {
+            return new Interface(channel, ns);
+        }, lazy);
+}
+
+bool InterfaceRegistry::unregisterNamespace(const QString& ns) {
+    const QByteArray key = ns.toUtf8();
+    if (builtins_.contains(key)) {
+        qWarning() << "Can not unregister the built in interface for" << ns;
+        return false;
+    }
+    QWriteLocker lock(&lock_);
+    entries_.remove(key);
+    return true;
+}
+
+bool InterfaceRegistry::isBuiltin(const QString& ns) const {
+    return builtins_.contains(ns.toUtf8());
+}
+
+Interface *InterfaceRegistry::create(Channel *channel,
+                                     const QString& ns) const {
+    Factory factory;
+    {
+        QReadLocker lock(&lock_);
+        auto it = entries_.constFind(ns.toUtf8());
+        if (it != entries_.constEnd()) {
+            factory = it->factory;
+        }
+    }
+    return factory ? factory(channel) : new Interface(channel, ns);
+}
+
+bool InterfaceRegistry::isLazy(ByteView ns) const {
+    const QByteArray key = QByteArray::fromRawData(ns.data(), ns.size());
+    QReadLocker lock(&lock_);
+    auto it = entries_.constFind(key);
+    return it != entries_.constEnd() && it->lazy;
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "cast-message.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+
+#include <functional>
+
+namespace cast {
+
+class Channel;
+class Interface;
+
+/* A process wide registry of the Interface types that handle each
+ * namespace, used by Channel::addInterface().  Namespaces without a
+ * registered factory get a generic Interface.
+ *
+ * A namespace may be registered as lazy, in which case its interface
+ * is created on a channel when the first message for the namespace
+ * arrives, rather than waiting for addInterface().  Interfaces for
+ * high volume namespaces can receive payloads as raw bytes by
+ * overriding Interface::handleUtf8() or Interface::handleBinary().
+ *
+ * The registry may be used from any thread.  The namespaces of the
+ * built in interfaces can not be replaced or unregistered.  QML
+ * reaches the registry through NamespaceRegistry.
+ */
+class InterfaceRegistry {
+public:
+    typedef std::function<Interface*(Channel*)> Factory;
+
+    static InterfaceRegistry& instance();
+
+    InterfaceRegistry(const InterfaceRegistry&) = delete;
+    InterfaceRegistry& operator=(const InterfaceRegistry&) = delete;
+
+    // These return false if the namespace belongs to a built in
+    // interface
+    bool registerFactory(const QString& ns, Factory factory,
+                         bool lazy=false);
+    template <typename T>
+    bool registerInterface(const QString& ns, bool lazy=false) {
+        return registerFactory(ns, [](Channel *channel) -> Interface* {
+                return new T(channel);
+            }, lazy);
+    }
+
+    // Register a namespace handled by a generic Interface.  When
+    // lazy, channels create the interface on the first message and
+    // announce it with Channel::interfaceAdded.
+    bool registerNamespace(const QString& ns, bool lazy=true);
+    bool unregisterNamespace(const QString& ns);
+
+    bool isBuiltin(const QString& ns) const;
+
+    // Create the interface for a namespace on the channel
+    Interface *create(Channel *channel, const QString& ns) const;
+    // Whether interfaces for the namespace are created on demand
+    bool isLazy(ByteView ns) const;
+
+private:
+    InterfaceRegistry();
+
+    struct Entry {
+        Factory factory;
+        bool lazy;
+    };
+
+    // Entries keyed on the UTF-8 namespace, as it appears on the wire
+    mutable QReadWriteLock lock_;
+    QHash<QByteArray,Entry> entries_;
+    // Set before the registry is shared, so read without the lock
+    QSet<QByteArray> builtins_;
+};
+
+}
@@ -17,12 +17,33 @@
 */
 
 #include "interface.h"
+#include "caster-stats.h"
 #include "channel.h"
+#include "wire-format.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QMetaMethod>
 
 namespace cast {
 
+QByteArray Interface::encodeEnvelope(const Channel& channel,
+                                     const QString& ns) {
+    QByteArray envelope;
+    wire::appendVarint(envelope, wire::Field::protocol_version,
+                       Caster::Message::CASTV2_1_0);
+    wire::appendBytes(envelope, wire::Field::source_id,
+                      channel.sourceId().toUtf8());
+    wire::appendBytes(envelope, wire::Field::destination_id,
+                      channel.destinationId().toUtf8());
+    wire::appendBytes(envelope, wire::Field::namespace_, ns.toUtf8());
+    return envelope;
+}
+
 Interface::Interface(Channel *channel, const QString& ns)
-    : QObject(channel), namespace_(ns) {
+    : QObject(channel), namespace_(ns),
+      envelope_(encodeEnvelope(*channel, ns)),
+      stats_(channel->caster().stats()->forNamespace(ns)) {
 }
 
 Interface::~Interface() = default;
@@ -35,6 +56,10 @@ const Channel& Interface::channel() const {
     return *static_cast<const Channel*>(parent());
 }
 
+const Caster& Interface::caster() const {
+    return channel().caster();
+}
+
 bool Interface::send(const QString& data) {
 #if 0
     qDebug() << "Sending message" << channel().source_id_
@@ -42,41 +67,42 @@ bool Interface::send(const QString& data) {
              << "namespace" << namespace_
              << "data" << data;
 #endif
-    Caster::Message message;
-    message.set_protocol_version(Caster::Message::CASTV2_1_0);
-    message.set_source_id(channel().source_id_.toStdString());
-    message.set_destination_id(channel().destination_id_.toStdString());
-    message.set_namespace_(namespace_.toStdString());
-    message.set_payload_type(Caster::Message::STRING);
-    message.set_payload_utf8(data.toStdString());
-    return channel().caster().sendMessage(message);
+    const QByteArray payload = data.toUtf8();
+    return sendUtf8(payload.constData(), payload.size());
+}
+
+bool Interface::sendUtf8(const char *data, int size) {
+    stats_.countSent(size);
+    return channel().caster().sendEncoded(
+        envelope_, Caster::Message::STRING, data, size);
 }
 
 bool Interface::sendBinary(const QByteArray& data) {
-    Caster::Message message;
-    message.set_protocol_version(Caster::Message::CASTV2_1_0);
-    message.set_source_id(channel().source_id_.toStdString());
-    message.set_destination_id(channel().destination_id_.toStdString());
-    message.set_namespace_(namespace_.toStdString());
-    message.set_payload_type(Caster::Message::BINARY);
-    message.set_payload_binary(data.constData(), data.size());
-    return channel().caster().sendMessage(message);
+    stats_.countSent(data.size());
+    return channel().caster().sendEncoded(
+        envelope_, Caster::Message::BINARY, data.constData(), data.size());
 }
 
 void Interface::handleMessage(const Caster::Message& message) {
     switch (message.payload_type()) {
-    case Caster::Message::STRING:
+    case Caster::Message::STRING: {
+        const auto& data = message.payload_utf8();
+        stats_.countReceived(data.size());
 #if 0
-        qDebug() << "Received message" << QString::fromStdString(message.source_id())
-                 << "->" << QString::fromStdString(message.destination_id())
-                 << "namespace" << QString::fromStdString(message.namespace_())
-                 << "data" << QString::fromStdString(message.payload_utf8());
+        qDebug() << "Received message"
+                 << QString::fromUtf8(message.source_id().data(), message.source_id().size())
+                 << "->" << QString::fromUtf8(message.destination_id().data(), message.destination_id().size())
+                 << "namespace" << namespace_
+                 << "data" << QString::fromUtf8(data.data(), data.size());
 #endif
-        Q_EMIT messageReceived(QString::fromStdString(message.payload_utf8()));
+        // Hand the payload over without copying it
+        handleUtf8(QByteArray::fromRawData(data.data(), data.size()));
         break;
+    }
     case Caster::Message::BINARY: {
         const auto& data = message.payload_binary();
-        Q_EMIT binaryMessageReceived(QByteArray(&data[0], data.size()));
+        stats_.countReceived(data.size());
+        handleBinary(QByteArray::fromRawData(data.data(), data.size()));
         break;
     }
     default:
@@ -85,4 +111,32 @@ void Interface::handleMessage(const Caster::Message& message) {
     }
 }
 
+void Interface::handleUtf8(const QByteArray& data) {
+    emitMessageReceived(data);
+}
+
+void Interface::handleBinary(const QByteArray& data) {
+    Q_EMIT binaryMessageReceived(QByteArray(data.constData(), data.size()));
+}
+
+void Interface::emitMessageReceived(const QByteArray& data) {
+    static const QMetaMethod signal =
+        QMetaMethod::fromSignal(&Interface::messageReceived);
+    if (isSignalConnected(signal)) {
+        Q_EMIT messageReceived(QString::fromUtf8(data));
+    }
+}
+
+bool Interface::parseJson(const QByteArray& data, QJsonObject& message) const {
+    QJsonParseError err;
+    auto doc = QJsonDocument::fromJson(data, &err);
+    if (err.error != QJsonParseError::NoError) {
+        qWarning() << "Could not parse message on" << namespace_ << ":"
+                   << err.errorString();
+        return false;
+    }
+    message = doc.object();
+    return true;
+}
+
 }
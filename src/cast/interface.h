@@ -21,12 +21,14 @@
 #include "caster.h"
 
 #include <QByteArray>
+#include <QJsonObject>
 #include <QObject>
 #include <QString>
 
 namespace cast {
 
 class Channel;
+struct NamespaceStats;
 
 class Interface : public QObject {
     Q_OBJECT
@@ -37,6 +39,11 @@ public:
 
     Q_INVOKABLE bool send(const QString& data);
     Q_INVOKABLE bool sendBinary(const QByteArray& data);
+    // Send a UTF-8 payload that has already been encoded
+    bool sendUtf8(const char *data, int size);
+
+    // Traffic counters for this interface's namespace
+    NamespaceStats& stats() { return stats_; }
 
 Q_SIGNALS:
     void messageReceived(const QString& data);
@@ -45,14 +52,37 @@ Q_SIGNALS:
 protected:
     Channel& channel();
     const Channel& channel() const;
+    // The Caster that owns the channel
+    const Caster& caster() const;
+
+    // Handle a UTF-8 payload.  The data is only valid for the
+    // duration of the call.  The default implementation emits
+    // messageReceived.
+    virtual void handleUtf8(const QByteArray& data);
+    // Handle a binary payload, which is only valid for the duration
+    // of the call.  The default implementation emits
+    // binaryMessageReceived with a copy.
+    virtual void handleBinary(const QByteArray& data);
+    // Emit messageReceived, if anything is connected to it
+    void emitMessageReceived(const QByteArray& data);
+    // Parse a payload as a JSON object, warning on failure
+    bool parseJson(const QByteArray& data, QJsonObject& message) const;
 
 private:
+    static QByteArray encodeEnvelope(const Channel& channel,
+                                     const QString& ns);
     void handleMessage(const Caster::Message& message);
     const QString& getNamespace() const { return namespace_; }
 
     const QString namespace_;
+    // The encoded message fields that stay the same for every message
+    // sent through this interface.
+    const QByteArray envelope_;
+    NamespaceStats& stats_;
 
+    friend class Caster;
     friend class Channel;
+    friend class RequestTracker;
 };
 
 }
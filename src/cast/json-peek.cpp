@@ -0,0 +1,154 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "json-peek.h"
+
+#include <climits>
+#include <cstring>
+
+namespace cast {
+namespace json {
+
+namespace {
+
+struct Scanner {
+    const char *p;
+    const char *end;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' ||
+                           *p == '\n' || *p == '\r')) ++p;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p == end || *p != c) return false;
+        ++p;
+        return true;
+    }
+
+    // Scan a string starting at the opening quote, returning its raw
+    // contents.
+    bool string(const char *&start, int &size) {
+        if (!consume('"')) return false;
+        start = p;
+        while (p < end && *p != '"') {
+            if (*p == '\\') ++p;
+            ++p;
+        }
+        if (p >= end) return false;
+        size = p - start;
+        ++p;
+        return true;
+    }
+
+    // Skip over a value of any type
+    bool skipValue() {
+        skipSpace();
+        if (p == end) return false;
+        if (*p == '"') {
+            const char *start;
+            int size;
+            return string(start, size);
+        }
+        if (*p != '{' && *p != '[') {
+            // Number, true, false or null
+            while (p < end && *p != ',' && *p != '}' && *p != ']') ++p;
+            return p < end;
+        }
+        int depth = 0;
+        while (p < end) {
+            const char c = *p;
+            if (c == '"') {
+                const char *start;
+                int size;
+                if (!string(start, size)) return false;
+                continue;
+            }
+            ++p;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return true;
+            }
+        }
+        return false;
+    }
+
+    // Position the scanner at the value of the given top level member
+    bool findMember(QLatin1String key) {
+        if (!consume('{')) return false;
+        if (consume('}')) return false;
+        do {
+            const char *name;
+            int name_size;
+            if (!string(name, name_size) || !consume(':')) return false;
+            if (name_size == key.size() &&
+                memcmp(name, key.data(), name_size) == 0) {
+                skipSpace();
+                return p < end;
+            }
+            if (!skipValue()) return false;
+        } while (consume(','));
+        return false;
+    }
+};
+
+}
+
+QLatin1String peekString(const QByteArray& json, QLatin1String key) {
+    Scanner scanner{json.constData(), json.constData() + json.size()};
+    const char *start;
+    int size;
+    if (!scanner.findMember(key) || *scanner.p != '"' ||
+        !scanner.string(start, size)) {
+        return QLatin1String();
+    }
+    return QLatin1String(start, size);
+}
+
+bool peekInt(const QByteArray& json, QLatin1String key, qint64& value) {
+    Scanner scanner{json.constData(), json.constData() + json.size()};
+    if (!scanner.findMember(key)) return false;
+
+    bool negative = false;
+    if (*scanner.p == '-') {
+        negative = true;
+        ++scanner.p;
+    }
+    if (scanner.p == scanner.end ||
+        *scanner.p < '0' || *scanner.p > '9') return false;
+    // Values are request and session ids, so anything outside the
+    // range of int is rejected rather than risking overflow
+    qint64 result = 0;
+    while (scanner.p < scanner.end &&
+           *scanner.p >= '0' && *scanner.p <= '9') {
+        result = result * 10 + (*scanner.p++ - '0');
+        if (result > INT_MAX) return false;
+    }
+    // Reject fractions and exponents
+    if (scanner.p < scanner.end &&
+        (*scanner.p == '.' || *scanner.p == 'e' || *scanner.p == 'E')) {
+        return false;
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+}
+}
@@ -0,0 +1,44 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QLatin1String>
+
+namespace cast {
+namespace json {
+
+/* Helpers to pick out top level members of a JSON object without
+ * building a QJsonDocument, so messages can be routed on their "type"
+ * and "requestId" before paying for a full parse.  They scan the
+ * UTF-8 text directly and give up (returning nothing) on malformed
+ * input, leaving error reporting to the full parser.
+ */
+
+// The raw contents of a top level string member, without processing
+// escape sequences.  Returns a null string if the member is missing
+// or is not a string.  The result points into json.
+QLatin1String peekString(const QByteArray& json, QLatin1String key);
+
+// The value of a top level integer member.  Returns false if the
+// member is missing, is not an integer or does not fit in an int.
+bool peekInt(const QByteArray& json, QLatin1String key, qint64& value);
+
+}
+}
@@ -0,0 +1,84 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "latency-histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cast {
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    // Values below 2 * sub_buckets get a bucket each.  Above that,
+    // each power of two is split into sub_buckets linear buckets.
+    if (value < 2 * sub_buckets) {
+        return static_cast<int>(value);
+    }
+    int msb = 63;
+    while (!(value >> msb)) --msb;
+    const int shift = msb - 3;
+    return shift * sub_buckets + static_cast<int>(value >> shift);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < 2 * sub_buckets) {
+        return index;
+    }
+    const int shift = index / sub_buckets - 1;
+    const uint64_t mantissa = index % sub_buckets + sub_buckets;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t usecs) {
+    buckets_[bucketIndex(usecs)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (usecs > current &&
+           !max_.compare_exchange_weak(current, usecs,
+                                       std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    const uint64_t target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(total * percent / 100.0)));
+    uint64_t seen = 0;
+    for (int i = 0; i < n_buckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+}
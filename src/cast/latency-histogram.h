@@ -0,0 +1,55 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cast {
+
+/* A log-linear histogram of latencies in microseconds, in the style of
+ * HdrHistogram.  Each power of two range is split into 8 buckets,
+ * bounding the relative error of reported percentiles to 12.5%.
+ * Recording is lock-free, and may happen concurrently with reads.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t usecs);
+    void reset();
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    // The latency below which the given percentage of samples fall
+    uint64_t percentile(double percent) const;
+
+private:
+    static const int sub_buckets = 8;
+    static const int n_buckets = 2 * sub_buckets + 60 * sub_buckets;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(int index);
+
+    std::atomic<uint64_t> buckets_[n_buckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> max_;
+};
+
+}
@@ -17,6 +17,7 @@
 */
 
 #include "media-interface.h"
+#include "command-encoder.h"
 
 #include <QDebug>
 #include <QJsonDocument>
@@ -28,68 +29,51 @@ namespace cast {
 const QString MediaInterface::URN = QStringLiteral("urn:x-cast:com.google.cast.media");
 
 MediaInterface::MediaInterface(Channel *channel)
-    : Interface(channel, URN) {
-    connect(this, &Interface::messageReceived,
-            this, &MediaInterface::onMessageReceived);
+    : Interface(channel, URN), requests_(this) {
     getStatus();
 }
 
 MediaInterface::~MediaInterface() = default;
 
-bool MediaInterface::getStatus() {
-    QJsonObject msg;
-    msg["type"] = QStringLiteral("GET_STATUS");
-    msg["requestId"] = ++last_request_;
-    QJsonDocument doc(msg);
-    return send(QString(doc.toJson(QJsonDocument::Compact)));
+PendingRequest* MediaInterface::getStatus() {
+    CommandEncoder command("GET_STATUS");
+    return requests_.send(command);
 }
 
-bool MediaInterface::play(int media_session_id) {
-    QJsonObject msg;
-    msg["type"] = QStringLiteral("PLAY");
-    msg["requestId"] = ++last_request_;
-    msg["mediaSessionId"] = media_session_id;
-    QJsonDocument doc(msg);
-    return send(QString(doc.toJson(QJsonDocument::Compact)));
+PendingRequest* MediaInterface::play(int media_session_id) {
+    CommandEncoder command("PLAY");
+    command.add("mediaSessionId", media_session_id);
+    return requests_.send(command);
 }
 
-bool MediaInterface::pause(int media_session_id) {
-    QJsonObject msg;
-    msg["type"] = QStringLiteral("PAUSE");
-    msg["requestId"] = ++last_request_;
-    msg["mediaSessionId"] = media_session_id;
-    QJsonDocument doc(msg);
-    return send(QString(doc.toJson(QJsonDocument::Compact)));
+PendingRequest* MediaInterface::pause(int media_session_id) {
+    CommandEncoder command("PAUSE");
+    command.add("mediaSessionId", media_session_id);
+    return requests_.send(command);
 }
 
-bool MediaInterface::stop(int media_session_id) {
-    QJsonObject msg;
-    msg["type"] = QStringLiteral("STOP");
-    msg["requestId"] = ++last_request_;
-    msg["mediaSessionId"] = media_session_id;
-    QJsonDocument doc(msg);
-    return send(QString(doc.toJson(QJsonDocument::Compact)));
+PendingRequest* MediaInterface::stop(int media_session_id) {
+    CommandEncoder command("STOP");
+    command.add("mediaSessionId", media_session_id);
+    return requests_.send(command);
 }
 
-bool MediaInterface::load(const QVariantMap& request) {
+PendingRequest* MediaInterface::load(const QVariantMap& request) {
     auto msg = QJsonObject::fromVariantMap(request);
     msg["type"] = QStringLiteral("LOAD");
-    msg["requestId"] = ++last_request_;
-    JSonDocument doc(msg);
-    return send(QString(doc.toJson(JsonDocument::Compact)));
+    return requests_.send(msg);
 }
 
-void MediaInterface::onMessageReceived(const QString& data) {
-    QJsonParseError err;
-    auto doc = QJsonDocument::fromJson(data.toUtf8(), &err);
-    if (err.error != QJsonParseError::NoError) {
-        qWarning() << "Could not parse message on connection channel:"
-                   << err.errorString();
-        return;
-    }
-    if (doc.object()["type"].toString() != "MEDIA_STATUS") return;
+void MediaInterface::handleUtf8(const QByteArray& data) {
+    requests_.handleUtf8(data, QLatin1String("MEDIA_STATUS"),
+                         [this](const QJsonObject& message) {
+                             updateStatus(message);
+                         });
+    Interface::handleUtf8(data);
+}
 
-    status_ = doc.object()["status"].toArray().toVariantList();
+void MediaInterface::updateStatus(const QJsonObject& message) {
+    sessions_.update(message["status"].toArray());
 
     Q_EMIT statusChanged();
 }
@@ -19,6 +19,9 @@
 #pragma once
 
 #include "interface.h"
+#include "media-session-model.h"
+#include "pending-request.h"
+#include "request-tracker.h"
 #include <QVariantList>
 
 namespace cast {
@@ -26,31 +29,45 @@ namespace cast {
 class MediaInterface : public Interface {
     Q_OBJECT
     Q_PROPERTY(QVariantList status READ status NOTIFY statusChanged)
+    Q_PROPERTY(cast::MediaSessionModel* sessions READ sessions CONSTANT)
+    Q_PROPERTY(double estimatedPosition READ estimatedPosition NOTIFY statusChanged)
+    Q_PROPERTY(int requestTimeout READ requestTimeout WRITE setRequestTimeout)
 public:
     MediaInterface(Channel *channel);
     virtual ~MediaInterface();
 
     static const QString URN;
 
-    bool getStatus();
-    Q_INVOKABLE bool play(int media_session_id);
-    Q_INVOKABLE bool pause(int media_session_id);
-    Q_INVOKABLE bool stop(int media_session_id);
+    Q_INVOKABLE cast::PendingRequest* getStatus();
+    Q_INVOKABLE cast::PendingRequest* play(int media_session_id);
+    Q_INVOKABLE cast::PendingRequest* pause(int media_session_id);
+    Q_INVOKABLE cast::PendingRequest* stop(int media_session_id);
 
-    Q_INVOKABLE bool load(const QVariantMap& request);
+    Q_INVOKABLE cast::PendingRequest* load(const QVariantMap& request);
+
+    // Playback position of the given media session, in seconds,
+    // extrapolated locally between MEDIA_STATUS updates.
+    Q_INVOKABLE double estimatedPositionOf(int media_session_id) const {
+        return sessions_.estimatedPosition(media_session_id);
+    }
 
 Q_SIGNALS:
     void statusChanged();
 
-private Q_SLOTS:
-    void onMessageReceived(const QString& data);
+protected:
+    void handleUtf8(const QByteArray& data) override;
 
 private:
-    QVariantList status() const { return status_; }
+    void updateStatus(const QJsonObject& message);
+    QVariantList status() const { return sessions_.toVariantList(); }
+    double estimatedPosition() const { return sessions_.estimatedPosition(); }
+    cast::MediaSessionModel* sessions() { return &sessions_; }
+    int requestTimeout() const { return requests_.timeout(); }
+    void setRequestTimeout(int timeout) { requests_.setTimeout(timeout); }
 
-    int last_request_ = 0;
+    RequestTracker requests_;
 
-    QVariantList status_;
+    MediaSessionModel sessions_{this};
 };
 
 }
@@ -0,0 +1,209 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "media-session-model.h"
+
+#include <QSet>
+#include <QVector>
+
+#include <algorithm>
+
+namespace cast {
+
+namespace {
+
+int mediaSessionId(const QJsonObject& status) {
+    return status["mediaSessionId"].toInt();
+}
+
+}
+
+MediaSessionModel::MediaSessionModel(QObject *parent)
+    : QAbstractListModel(parent) {
+    roles[RoleMediaSessionId] = "mediaSessionId";
+    roles[RolePlayerState] = "playerState";
+    roles[RoleCurrentTime] = "currentTime";
+    roles[RolePlaybackRate] = "playbackRate";
+    roles[RoleVolumeLevel] = "volumeLevel";
+    roles[RoleVolumeMuted] = "volumeMuted";
+    roles[RoleIdleReason] = "idleReason";
+    roles[RoleMedia] = "media";
+    roles[RoleSupportedMediaCommands] = "supportedMediaCommands";
+    roles[RoleStatus] = "status";
+    clock_.start();
+}
+
+MediaSessionModel::~MediaSessionModel() = default;
+
+int MediaSessionModel::findRow(int media_session_id) const {
+    for (int i = 0; i < static_cast<int>(sessions_.size()); ++i) {
+        if (mediaSessionId(sessions_[i].status) == media_session_id) return i;
+    }
+    return -1;
+}
+
+void MediaSessionModel::update(const QJsonArray& status) {
+    QSet<int> session_ids;
+    for (const auto& value : status) {
+        session_ids.insert(mediaSessionId(value.toObject()));
+    }
+
+    // Remove sessions that are no longer reported
+    for (int i = static_cast<int>(sessions_.size()) - 1; i >= 0; --i) {
+        if (!session_ids.contains(mediaSessionId(sessions_[i].status))) {
+            beginRemoveRows(QModelIndex(), i, i);
+            sessions_.erase(sessions_.begin() + i);
+            endRemoveRows();
+        }
+    }
+
+    for (const auto& value : status) {
+        const QJsonObject session = value.toObject();
+        const int row = findRow(mediaSessionId(session));
+        if (row >= 0) {
+            mergeRow(row, session);
+        } else {
+            const int end = sessions_.size();
+            beginInsertRows(QModelIndex(), end, end);
+            sessions_.push_back({session, clock_.elapsed()});
+            endInsertRows();
+        }
+    }
+}
+
+void MediaSessionModel::mergeRow(int row, const QJsonObject& status) {
+    QJsonObject& session = sessions_[row].status;
+    QVector<int> changed;
+
+    // Every status report resyncs the position estimate, even if
+    // the reported time is unchanged (e.g. while paused)
+    if (status.contains(QLatin1String("currentTime"))) {
+        sessions_[row].synced_at = clock_.elapsed();
+    }
+
+    for (auto it = status.begin(); it != status.end(); ++it) {
+        const QJsonValue old = session.value(it.key());
+        if (old == it.value()) continue;
+
+        const QString& key = it.key();
+        if (key == QLatin1String("playerState")) {
+            changed.append(RolePlayerState);
+        } else if (key == QLatin1String("currentTime")) {
+            changed.append(RoleCurrentTime);
+        } else if (key == QLatin1String("playbackRate")) {
+            changed.append(RolePlaybackRate);
+        } else if (key == QLatin1String("idleReason")) {
+            changed.append(RoleIdleReason);
+        } else if (key == QLatin1String("media")) {
+            changed.append(RoleMedia);
+        } else if (key == QLatin1String("supportedMediaCommands")) {
+            changed.append(RoleSupportedMediaCommands);
+        } else if (key == QLatin1String("volume")) {
+            const auto old_volume = old.toObject();
+            const auto new_volume = it.value().toObject();
+            if (old_volume["level"] != new_volume["level"]) {
+                changed.append(RoleVolumeLevel);
+            }
+            if (old_volume["muted"] != new_volume["muted"]) {
+                changed.append(RoleVolumeMuted);
+            }
+        }
+        session.insert(key, it.value());
+    }
+    // The receiver only reports an idle reason while idle
+    if (!status.contains(QLatin1String("idleReason")) &&
+        session.contains(QLatin1String("idleReason")) &&
+        status.contains(QLatin1String("playerState"))) {
+        session.remove(QLatin1String("idleReason"));
+        changed.append(RoleIdleReason);
+    }
+
+    if (changed.isEmpty()) return;
+    changed.append(RoleStatus);
+    const auto index = createIndex(row, 0);
+    Q_EMIT dataChanged(index, index, changed);
+}
+
+QVariantList MediaSessionModel::toVariantList() const {
+    QVariantList result;
+    for (const auto& session : sessions_) {
+        result.append(session.status.toVariantMap());
+    }
+    return result;
+}
+
+double MediaSessionModel::estimatedPosition(int media_session_id) const {
+    const int row = media_session_id < 0 ?
+        (sessions_.empty() ? -1 : 0) : findRow(media_session_id);
+    if (row < 0) return -1;
+
+    const Session& session = sessions_[row];
+    double position = session.status["currentTime"].toDouble();
+    if (session.status["playerState"].toString() != QLatin1String("PLAYING")) {
+        return position;
+    }
+    const double rate = session.status["playbackRate"].toDouble(1.0);
+    position += rate * (clock_.elapsed() - session.synced_at) / 1000.0;
+
+    // Don't run past the end of the media, if its duration is known
+    const double duration =
+        session.status["media"].toObject()["duration"].toDouble(-1);
+    if (duration >= 0 && position > duration) position = duration;
+    return std::max(position, 0.0);
+}
+
+int MediaSessionModel::rowCount(const QModelIndex &parent) const {
+    return sessions_.size();
+}
+
+QVariant MediaSessionModel::data(const QModelIndex &index, int role) const {
+    int i = index.row();
+    if (i < 0 || i >= static_cast<int>(sessions_.size())) return QVariant();
+
+    const QJsonObject& session = sessions_[i].status;
+    switch (role) {
+    case RoleMediaSessionId:
+        return mediaSessionId(session);
+    case RolePlayerState:
+        return session["playerState"].toVariant();
+    case RoleCurrentTime:
+        return session["currentTime"].toDouble();
+    case RolePlaybackRate:
+        return session["playbackRate"].toDouble(1.0);
+    case RoleVolumeLevel:
+        return session["volume"].toObject()["level"].toDouble();
+    case RoleVolumeMuted:
+        return session["volume"].toObject()["muted"].toBool();
+    case RoleIdleReason:
+        return session["idleReason"].toVariant();
+    case RoleMedia:
+        return session["media"].toObject().toVariantMap();
+    case RoleSupportedMediaCommands:
+        return session["supportedMediaCommands"].toInt();
+    case RoleStatus:
+        return session.toVariantMap();
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int,QByteArray> MediaSessionModel::roleNames() const {
+    return roles;
+}
+
+}
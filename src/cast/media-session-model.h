@@ -0,0 +1,89 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVariantList>
+
+#include <vector>
+
+namespace cast {
+
+/* MediaSessionModel lists the media sessions reported by MEDIA_STATUS
+ * messages, keyed on mediaSessionId.  Each status entry is merged
+ * into the existing session, since the receiver omits fields that
+ * have not changed, and dataChanged is only emitted for the roles
+ * whose values changed.
+ */
+class MediaSessionModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit MediaSessionModel(QObject *parent=nullptr);
+    virtual ~MediaSessionModel();
+
+    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    enum Roles {
+        RoleMediaSessionId = Qt::UserRole + 1,
+        RolePlayerState,
+        RoleCurrentTime,
+        RolePlaybackRate,
+        RoleVolumeLevel,
+        RoleVolumeMuted,
+        RoleIdleReason,
+        RoleMedia,
+        RoleSupportedMediaCommands,
+        RoleStatus,
+    };
+    Q_ENUM(Roles);
+
+    // Apply the "status" list from a MEDIA_STATUS message
+    void update(const QJsonArray& status);
+
+    // The merged status of every session
+    QVariantList toVariantList() const;
+
+    // The playback position of the given session in seconds,
+    // extrapolated from the last reported currentTime, or -1 if the
+    // session is unknown.  A negative id selects the first session.
+    double estimatedPosition(int media_session_id=-1) const;
+
+protected:
+    QHash<int,QByteArray> roleNames() const override;
+
+private:
+    struct Session {
+        QJsonObject status;
+        // When currentTime was last reported, on clock_
+        qint64 synced_at;
+    };
+
+    int findRow(int media_session_id) const;
+    void mergeRow(int row, const QJsonObject& status);
+
+    QHash<int, QByteArray> roles;
+    std::vector<Session> sessions_;
+    QElapsedTimer clock_;
+};
+
+}
@@ -0,0 +1,65 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "namespace-filter.h"
+#include "caster-stats.h"
+#include "interface-registry.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace cast {
+
+NamespaceFilter::NamespaceFilter(CasterStats& stats) : stats_(stats) {
+}
+
+NamespaceFilter::~NamespaceFilter() = default;
+
+void NamespaceFilter::subscribe(const QString& ns) {
+    QWriteLocker lock(&lock_);
+    ++subscribers_[ns.toUtf8()];
+}
+
+void NamespaceFilter::unsubscribe(const QString& ns) {
+    QWriteLocker lock(&lock_);
+    auto it = subscribers_.find(ns.toUtf8());
+    if (it != subscribers_.end() && --it.value() <= 0) {
+        subscribers_.erase(it);
+    }
+}
+
+void NamespaceFilter::clear() {
+    QWriteLocker lock(&lock_);
+    subscribers_.clear();
+}
+
+bool NamespaceFilter::accept(ByteView ns, uint32_t frame_size) {
+    // Look the namespace up in place, without copying it
+    const QByteArray key = QByteArray::fromRawData(ns.data(), ns.size());
+    {
+        QReadLocker lock(&lock_);
+        if (subscribers_.contains(key)) return true;
+    }
+    // Interfaces for lazy namespaces are created by the first message
+    if (InterfaceRegistry::instance().isLazy(ns)) return true;
+
+    stats_.countDropped(key, frame_size);
+    return false;
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "cast-message.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+
+#include <cstdint>
+
+namespace cast {
+
+class CasterStats;
+
+/* NamespaceFilter tracks which namespaces have an Interface on any
+ * channel or are registered as lazy in the InterfaceRegistry, so
+ * incoming frames for other namespaces can be dropped by
+ * the I/O thread as soon as their namespace has been read, before the
+ * payload is decoded or the frame is queued for the Caster.  Dropped
+ * frames are counted in the namespace's statistics.
+ *
+ * Subscriptions are managed from the Caster's thread, while accept()
+ * is called by the connection's reader.
+ */
+class NamespaceFilter {
+public:
+    explicit NamespaceFilter(CasterStats& stats);
+    ~NamespaceFilter();
+
+    NamespaceFilter(const NamespaceFilter&) = delete;
+    NamespaceFilter& operator=(const NamespaceFilter&) = delete;
+
+    void subscribe(const QString& ns);
+    void unsubscribe(const QString& ns);
+    void clear();
+
+    // Whether a frame for the namespace should be delivered.  If
+    // not, the drop is counted against the namespace.
+    bool accept(ByteView ns, uint32_t frame_size);
+
+private:
+    CasterStats& stats_;
+
+    // Subscriber counts, keyed on the UTF-8 namespace
+    mutable QReadWriteLock lock_;
+    QHash<QByteArray,int> subscribers_;
+};
+
+}
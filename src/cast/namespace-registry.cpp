@@ -0,0 +1,42 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "namespace-registry.h"
+#include "interface-registry.h"
+
+namespace cast {
+
+NamespaceRegistry::NamespaceRegistry(QObject *parent)
+    : QObject(parent) {
+}
+
+NamespaceRegistry::~NamespaceRegistry() = default;
+
+bool NamespaceRegistry::registerNamespace(const QString& ns, bool lazy) {
+    return InterfaceRegistry::instance().registerNamespace(ns, lazy);
+}
+
+bool NamespaceRegistry::unregisterNamespace(const QString& ns) {
+    return InterfaceRegistry::instance().unregisterNamespace(ns);
+}
+
+bool NamespaceRegistry::isBuiltin(const QString& ns) const {
+    return InterfaceRegistry::instance().isBuiltin(ns);
+}
+
+}
@@ -0,0 +1,44 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+namespace cast {
+
+/* NamespaceRegistry exposes the process wide InterfaceRegistry to
+ * QML as the InterfaceRegistry singleton.  One is created for each
+ * engine, so it lives on the engine's thread, while the registry
+ * itself is a plain object that any thread may use.
+ */
+class NamespaceRegistry : public QObject {
+    Q_OBJECT
+public:
+    explicit NamespaceRegistry(QObject *parent=nullptr);
+    virtual ~NamespaceRegistry();
+
+    // Register a namespace handled by a generic Interface.  Returns
+    // false for the namespaces of the built in interfaces.
+    Q_INVOKABLE bool registerNamespace(const QString& ns, bool lazy=true);
+    Q_INVOKABLE bool unregisterNamespace(const QString& ns);
+    Q_INVOKABLE bool isBuiltin(const QString& ns) const;
+};
+
+}
@@ -0,0 +1,46 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pending-request.h"
+
+namespace cast {
+
+PendingRequest::PendingRequest(QObject *parent, int request_id)
+    : QObject(parent), request_id_(request_id) {
+}
+
+PendingRequest::~PendingRequest() = default;
+
+void PendingRequest::succeed(const QVariantMap& reply) {
+    if (done_) return;
+    done_ = true;
+    reply_ = reply;
+    Q_EMIT replied(reply_);
+    Q_EMIT finished();
+}
+
+void PendingRequest::fail(const QString& error, const QVariantMap& reply) {
+    if (done_) return;
+    done_ = true;
+    error_ = error;
+    reply_ = reply;
+    Q_EMIT failed(error_);
+    Q_EMIT finished();
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+namespace cast {
+
+/* PendingRequest tracks a command sent to the device until the reply
+ * carrying its requestId arrives, the device reports an error, or
+ * the request times out.  It is deleted shortly after finishing, so
+ * handlers should copy anything they need from it.
+ */
+class PendingRequest : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int requestId READ requestId CONSTANT)
+    Q_PROPERTY(bool done READ isDone NOTIFY finished)
+    Q_PROPERTY(QVariantMap reply READ reply NOTIFY finished)
+    Q_PROPERTY(QString error READ error NOTIFY finished)
+public:
+    PendingRequest(QObject *parent, int request_id);
+    virtual ~PendingRequest();
+
+    int requestId() const { return request_id_; }
+    bool isDone() const { return done_; }
+    const QVariantMap& reply() const { return reply_; }
+    // Empty if the request succeeded
+    const QString& error() const { return error_; }
+
+    void succeed(const QVariantMap& reply);
+    void fail(const QString& error, const QVariantMap& reply=QVariantMap());
+
+Q_SIGNALS:
+    void replied(const QVariantMap& reply);
+    void failed(const QString& error);
+    // Emitted after replied() or failed()
+    void finished();
+
+private:
+    const int request_id_;
+    bool done_ = false;
+    QVariantMap reply_;
+    QString error_;
+};
+
+}
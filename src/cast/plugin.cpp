@@ -17,21 +17,47 @@
 */
 
 #include "plugin.h"
+#include "application-model.h"
 #include "caster.h"
+#include "caster-pool.h"
+#include "caster-stats.h"
 #include "channel.h"
 #include "interface.h"
+#include "media-session-model.h"
+#include "namespace-registry.h"
+#include "pending-request.h"
 #include "receiver-interface.h"
 
 namespace cast {
 
+namespace {
+
+QObject *interfaceRegistryProvider(QQmlEngine *, QJSEngine *) {
+    // Owned by the engine, which creates it on its own thread
+    return new NamespaceRegistry;
+}
+
+}
+
 void CastPlugin::registerTypes(const char *uri) {
     qmlRegisterType<Caster>(uri, 0, 1, "Caster");
+    qmlRegisterType<CasterPool>(uri, 0, 1, "CasterPool");
+    qmlRegisterUncreatableType<CasterStats>(
+        uri, 0, 1, "CasterStats", "Use Caster.stats");
     qmlRegisterUncreatableType<Channel>(
         uri, 0, 1, "Channel", "Use a Caster to create channels");
     qmlRegisterUncreatableType<Interface>(
         uri, 0, 1, "Interface", "Use a Channel to create interfaces");
+    qmlRegisterSingletonType<NamespaceRegistry>(
+        uri, 0, 1, "InterfaceRegistry", interfaceRegistryProvider);
     qmlRegisterUncreatableType<ReceiverInterface>(
         uri, 0, 1, "ReceiverInterface", "Use a Channel to create interfaces");
+    qmlRegisterUncreatableType<ApplicationModel>(
+        uri, 0, 1, "ApplicationModel", "Use ReceiverInterface.applicationModel");
+    qmlRegisterUncreatableType<MediaSessionModel>(
+        uri, 0, 1, "MediaSessionModel", "Use MediaInterface.sessions");
+    qmlRegisterUncreatableType<PendingRequest>(
+        uri, 0, 1, "PendingRequest", "Returned by interface commands");
 }
 
 }
@@ -17,6 +17,7 @@
 */
 
 #include "receiver-interface.h"
+#include "command-encoder.h"
 
 #include <QDebug>
 #include <QJsonDocument>
@@ -28,56 +29,62 @@ namespace cast {
 const QString ReceiverInterface::URN = QStringLiteral("urn:x-cast:com.google.cast.receiver");
 
 ReceiverInterface::ReceiverInterface(Channel *channel)
-    : Interface(channel, URN) {
-    connect(this, &Interface::messageReceived,
-            this, &ReceiverInterface::onMessageReceived);
+    : Interface(channel, URN), requests_(this) {
     getStatus();
 }
 
 ReceiverInterface::~ReceiverInterface() = default;
 
-bool ReceiverInterface::launch(const QString& app_id) {
-    QJsonObject msg;
-    msg["type"] = QStringLiteral("LAUNCH");
-    msg["requestId"] = ++last_request_;
-    msg["appId"] = app_id;
-    QJsonDocument doc(msg);
-    return send(QString(doc.toJson(QJsonDocument::Compact)));
+PendingRequest* ReceiverInterface::launch(const QString& app_id) {
+    CommandEncoder command("LAUNCH");
+    command.add("appId", app_id);
+    return requests_.send(command);
 }
 
-bool ReceiverInterface::stop(const QString& session_id) {
-    QJsonObject msg;
-    msg["type"] = QStringLiteral("STOP");
-    msg["requestId"] = ++last_request_;
-    msg["sessionId"] = session_id;
-    QJsonDocument doc(msg);
-    return send(QString(doc.toJson(QJsonDocument::Compact)));
+PendingRequest* ReceiverInterface::stop(const QString& session_id) {
+    CommandEncoder command("STOP");
+    command.add("sessionId", session_id);
+    return requests_.send(command);
 }
 
-bool ReceiverInterface::getStatus() {
-    QJsonObject msg;
-    msg["type"] = QStringLiteral("GET_STATUS");
-    msg["requestId"] = ++last_request_;
-    QJsonDocument doc(msg);
-    return send(QString(doc.toJson(QJsonDocument::Compact)));
+PendingRequest* ReceiverInterface::getStatus() {
+    CommandEncoder command("GET_STATUS");
+    return requests_.send(command);
 }
 
-void ReceiverInterface::onMessageReceived(const QString& data) {
-    QJsonParseError err;
-    auto doc = QJsonDocument::fromJson(data.toUtf8(), &err);
-    if (err.error != QJsonParseError::NoError) {
-        qWarning() << "Could not parse message on connection channel:"
-                   << err.errorString();
-        return;
-    }
-    if (doc.object()["type"].toString() != "RECEIVER_STATUS") return;
+void ReceiverInterface::handleUtf8(const QByteArray& data) {
+    requests_.handleUtf8(data, QLatin1String("RECEIVER_STATUS"),
+                         [this](const QJsonObject& message) {
+                             updateStatus(message);
+                         });
+    Interface::handleUtf8(data);
+}
 
-    const auto status = doc.object()["status"].toObject();
-    applications_ = status["applications"].toArray().toVariantList();
-    is_active_input_ = status["isActiveInput"].toBool();
+void ReceiverInterface::updateStatus(const QJsonObject& message) {
+    const auto status = message["status"].toObject();
+    const auto applications = status["applications"].toArray();
+    if (applications != applications_json_) {
+        applications_json_ = applications;
+        applications_ = applications.toVariantList();
+        application_model_.update(applications);
+        Q_EMIT applicationsChanged();
+    }
+    const bool is_active_input = status["isActiveInput"].toBool();
+    if (is_active_input != is_active_input_) {
+        is_active_input_ = is_active_input;
+        Q_EMIT isActiveInputChanged();
+    }
     const auto volume = status["volume"].toObject();
-    volume_level_ = volume["level"].toDouble();
-    volume_muted_ = volume["muted"].toBool();
+    const double volume_level = volume["level"].toDouble();
+    if (volume_level != volume_level_) {
+        volume_level_ = volume_level;
+        Q_EMIT volumeLevelChanged();
+    }
+    const bool volume_muted = volume["muted"].toBool();
+    if (volume_muted != volume_muted_) {
+        volume_muted_ = volume_muted;
+        Q_EMIT volumeMutedChanged();
+    }
 
     Q_EMIT statusChanged();
 }
@@ -18,42 +18,61 @@
 
 #pragma once
 
+#include "application-model.h"
 #include "interface.h"
+#include "pending-request.h"
+#include "request-tracker.h"
+#include <QJsonArray>
 #include <QVariantList>
 
 namespace cast {
 
 class ReceiverInterface : public Interface {
     Q_OBJECT
-    Q_PROPERTY(QVariantList applications READ applications NOTIFY statusChanged)
-    Q_PROPERTY(bool isActiveInput READ isActiveInput NOTIFY statusChanged)
-    Q_PROPERTY(double volumeLevel READ volumeLevel NOTIFY statusChanged)
-    Q_PROPERTY(bool volumeMuted READ volumeMuted NOTIFY statusChanged)
+    Q_PROPERTY(QVariantList applications READ applications NOTIFY applicationsChanged)
+    Q_PROPERTY(cast::ApplicationModel* applicationModel READ applicationModel CONSTANT)
+    Q_PROPERTY(bool isActiveInput READ isActiveInput NOTIFY isActiveInputChanged)
+    Q_PROPERTY(double volumeLevel READ volumeLevel NOTIFY volumeLevelChanged)
+    Q_PROPERTY(bool volumeMuted READ volumeMuted NOTIFY volumeMutedChanged)
+    Q_PROPERTY(int requestTimeout READ requestTimeout WRITE setRequestTimeout)
 public:
     ReceiverInterface(Channel *channel);
     virtual ~ReceiverInterface();
 
     static const QString URN;
 
-    Q_INVOKABLE bool launch(const QString& app_id);
-    Q_INVOKABLE bool stop(const QString& session_id);
-    bool getStatus();
+    Q_INVOKABLE cast::PendingRequest* launch(const QString& app_id);
+    Q_INVOKABLE cast::PendingRequest* stop(const QString& session_id);
+    Q_INVOKABLE cast::PendingRequest* getStatus();
 
 Q_SIGNALS:
+    // Emitted for every RECEIVER_STATUS, after the property specific
+    // signals for whatever changed.
     void statusChanged();
 
-private Q_SLOTS:
-    void onMessageReceived(const QString& data);
+    void applicationsChanged();
+    void isActiveInputChanged();
+    void volumeLevelChanged();
+    void volumeMutedChanged();
+
+protected:
+    void handleUtf8(const QByteArray& data) override;
 
 private:
+    void updateStatus(const QJsonObject& message);
     QVariantList applications() const { return applications_; }
+    ApplicationModel* applicationModel() { return &application_model_; }
     bool isActiveInput() const { return is_active_input_; }
     double volumeLevel() const { return volume_level_; }
     bool volumeMuted() const { return volume_muted_; }
+    int requestTimeout() const { return requests_.timeout(); }
+    void setRequestTimeout(int timeout) { requests_.setTimeout(timeout); }
 
-    int last_request_ = 0;
+    RequestTracker requests_;
 
+    QJsonArray applications_json_;
     QVariantList applications_;
+    ApplicationModel application_model_{this};
     bool is_active_input_ = false;
     double volume_level_ = 1.0;
     bool volume_muted_ = false;
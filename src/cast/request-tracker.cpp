@@ -0,0 +1,160 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "request-tracker.h"
+#include "caster-stats.h"
+#include "command-encoder.h"
+#include "interface.h"
+#include "json-peek.h"
+#include "pending-request.h"
+
+#include <QJsonDocument>
+#include <QQmlEngine>
+
+#include <algorithm>
+
+namespace cast {
+
+namespace {
+
+bool isErrorReply(const QString& type) {
+    return type == QLatin1String("INVALID_REQUEST") ||
+        type == QLatin1String("LAUNCH_ERROR") ||
+        type == QLatin1String("LOAD_FAILED") ||
+        type == QLatin1String("LOAD_CANCELLED") ||
+        type == QLatin1String("INVALID_PLAYER_STATE");
+}
+
+}
+
+RequestTracker::RequestTracker(Interface *iface)
+    : QObject(iface), iface_(*iface) {
+    clock_.start();
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout,
+            this, &RequestTracker::onTimeout);
+}
+
+RequestTracker::~RequestTracker() {
+    for (const auto& entry : pending_) {
+        entry.second.request->fail(QStringLiteral("Interface closed"));
+    }
+}
+
+void RequestTracker::setTimeout(int timeout) {
+    timeout_ = timeout;
+}
+
+PendingRequest *RequestTracker::send(QJsonObject message) {
+    const int request_id = ++last_request_;
+    message["requestId"] = request_id;
+    const QByteArray payload =
+        QJsonDocument(message).toJson(QJsonDocument::Compact);
+    if (!iface_.sendUtf8(payload.constData(), payload.size())) {
+        return nullptr;
+    }
+    return track(request_id);
+}
+
+PendingRequest *RequestTracker::send(CommandEncoder& command) {
+    const int request_id = ++last_request_;
+    command.finish(request_id);
+    if (!iface_.sendUtf8(command.data(), command.size())) {
+        return nullptr;
+    }
+    return track(request_id);
+}
+
+PendingRequest *RequestTracker::track(int request_id) {
+    auto request = new PendingRequest(this, request_id);
+    // The tracker deletes requests once they finish
+    QQmlEngine::setObjectOwnership(request, QQmlEngine::CppOwnership);
+    pending_.emplace(request_id, Pending{request, clock_.nsecsElapsed()});
+    deadlines_.emplace_back(clock_.elapsed() + timeout_, request_id);
+    if (!timer_.isActive()) {
+        scheduleTimeout();
+    }
+    return request;
+}
+
+void RequestTracker::handleReply(const QJsonObject& message) {
+    const int request_id = message["requestId"].toInt();
+    if (request_id == 0) return;
+    auto it = pending_.find(request_id);
+    if (it == pending_.end()) return;
+    PendingRequest *request = it->second.request;
+    iface_.stats().request_latency.record(
+        (clock_.nsecsElapsed() - it->second.sent_at) / 1000);
+    pending_.erase(it);
+
+    const QString type = message["type"].toString();
+    if (isErrorReply(type)) {
+        const QString reason = message["reason"].toString();
+        request->fail(reason.isEmpty() ? type : type + ": " + reason,
+                      message.toVariantMap());
+    } else {
+        request->succeed(message.toVariantMap());
+    }
+    request->deleteLater();
+}
+
+void RequestTracker::handleUtf8(
+        const QByteArray& data, QLatin1String status_type,
+        const std::function<void(const QJsonObject&)>& on_status) {
+    // Only build a JSON document for status updates and replies to
+    // our own requests
+    const bool is_status =
+        json::peekString(data, QLatin1String("type")) == status_type;
+    qint64 request_id = 0;
+    json::peekInt(data, QLatin1String("requestId"), request_id);
+    if (!is_status && !isPending(request_id)) return;
+
+    QJsonObject message;
+    if (!iface_.parseJson(data, message)) return;
+    handleReply(message);
+    if (is_status) {
+        on_status(message);
+    }
+}
+
+void RequestTracker::onTimeout() {
+    const qint64 now = clock_.elapsed();
+    while (!deadlines_.empty() && deadlines_.front().first <= now) {
+        auto it = pending_.find(deadlines_.front().second);
+        deadlines_.pop_front();
+        if (it == pending_.end()) continue;
+        PendingRequest *request = it->second.request;
+        pending_.erase(it);
+        request->fail(QStringLiteral("Request timed out"));
+        request->deleteLater();
+    }
+    scheduleTimeout();
+}
+
+void RequestTracker::scheduleTimeout() {
+    // Skip over requests that have already been answered
+    while (!deadlines_.empty() &&
+           pending_.find(deadlines_.front().second) == pending_.end()) {
+        deadlines_.pop_front();
+    }
+    if (deadlines_.empty()) return;
+    const qint64 wait = deadlines_.front().first - clock_.elapsed();
+    timer_.start(static_cast<int>(std::max<qint64>(wait, 0)));
+}
+
+}
@@ -0,0 +1,96 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QLatin1String>
+#include <QObject>
+#include <QTimer>
+
+#include <climits>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace cast {
+
+class CommandEncoder;
+class Interface;
+class PendingRequest;
+
+/* RequestTracker assigns request ids to the commands sent through an
+ * Interface and matches the device's replies back to them, so each
+ * command can be followed through its own PendingRequest.
+ */
+class RequestTracker : public QObject {
+    Q_OBJECT
+public:
+    explicit RequestTracker(Interface *iface);
+    virtual ~RequestTracker();
+
+    // Time to wait for a reply before failing a request, in msecs
+    int timeout() const { return timeout_; }
+    void setTimeout(int timeout);
+
+    // Assign a requestId to the message and send it.  Returns
+    // nullptr if the message could not be sent.
+    PendingRequest *send(QJsonObject message);
+    PendingRequest *send(CommandEncoder& command);
+
+    // Whether a reply with the given requestId is still awaited
+    bool isPending(qint64 request_id) const {
+        return request_id > 0 && request_id <= INT_MAX &&
+            pending_.count(int(request_id)) != 0;
+    }
+
+    // Complete the pending request that a message replies to, if any
+    void handleReply(const QJsonObject& message);
+
+    // Handle a UTF-8 payload received by the interface.  Only
+    // messages of the given status type and replies to pending
+    // requests are parsed.  Replies complete their request, and
+    // status messages are passed to on_status.
+    void handleUtf8(const QByteArray& data, QLatin1String status_type,
+                    const std::function<void(const QJsonObject&)>& on_status);
+
+private Q_SLOTS:
+    void onTimeout();
+
+private:
+    PendingRequest *track(int request_id);
+    void scheduleTimeout();
+
+    Interface& iface_;
+    int last_request_ = 0;
+    int timeout_ = 10000;
+
+    struct Pending {
+        PendingRequest *request;
+        qint64 sent_at;
+    };
+    std::unordered_map<int,Pending> pending_;
+    // Request deadlines in the order the requests were sent
+    std::deque<std::pair<qint64,int>> deadlines_;
+    QElapsedTimer clock_;
+    QTimer timer_;
+};
+
+}
@@ -0,0 +1,120 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+
+namespace cast {
+
+/* An unbounded lock-free queue for one producer thread and one
+ * consumer thread.  Nodes are recycled by the producer once the
+ * consumer has finished with them, so a queue that has reached its
+ * working size no longer allocates.
+ *
+ * The producer fills in the item returned by prepare() and publishes
+ * it with push().  The consumer reads the item returned by front()
+ * and releases it with pop().
+ */
+template <typename T>
+class SpscQueue {
+public:
+    SpscQueue() {
+        Node *n = new Node;
+        head_ = first_ = tail_copy_ = n;
+        tail_.store(n, std::memory_order_relaxed);
+    }
+
+    ~SpscQueue() {
+        delete pending_;
+        Node *n = first_;
+        while (n) {
+            Node *next = n->next.load(std::memory_order_relaxed);
+            delete n;
+            n = next;
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer: return the item that the next push() will publish.
+    // Calling prepare() again without push() returns the same item.
+    T& prepare() {
+        if (!pending_) {
+            pending_ = allocNode();
+            pending_->next.store(nullptr, std::memory_order_relaxed);
+        }
+        return pending_->value;
+    }
+
+    // Producer: publish the prepared item.
+    void push() {
+        prepare();
+        head_->next.store(pending_, std::memory_order_release);
+        head_ = pending_;
+        pending_ = nullptr;
+    }
+
+    // Consumer: return the oldest published item, or nullptr.
+    T *front() {
+        Node *n = tail_.load(std::memory_order_relaxed)
+            ->next.load(std::memory_order_acquire);
+        return n ? &n->value : nullptr;
+    }
+
+    // Consumer: release the item returned by front().
+    void pop() {
+        Node *t = tail_.load(std::memory_order_relaxed);
+        tail_.store(t->next.load(std::memory_order_relaxed),
+                    std::memory_order_release);
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    Node *allocNode() {
+        if (first_ != tail_copy_) {
+            return takeFirst();
+        }
+        tail_copy_ = tail_.load(std::memory_order_acquire);
+        if (first_ != tail_copy_) {
+            return takeFirst();
+        }
+        return new Node;
+    }
+
+    Node *takeFirst() {
+        Node *n = first_;
+        first_ = first_->next.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    // Consumer side
+    std::atomic<Node*> tail_;
+    // Producer side: nodes in [first_, tail_copy_) can be reused
+    Node *head_;
+    Node *first_;
+    Node *tail_copy_;
+    Node *pending_ = nullptr;
+};
+
+}
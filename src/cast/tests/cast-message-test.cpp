@@ -0,0 +1,265 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cast-message.h"
+
+#include <QtTest>
+
+#include <random>
+#include <string>
+
+#ifdef CAST_HAVE_PROTOBUF
+#include "cast_channel.pb.h"
+
+#include <google/protobuf/stubs/common.h>
+
+typedef extensions::api::cast_channel::CastMessage ProtobufMessage;
+#endif
+
+namespace cast {
+
+namespace {
+
+const char test_ns[] = "urn:x-cast:com.google.cast.media";
+const char test_payload[] =
+    R"({"type": "MEDIA_STATUS", "requestId": 42, "status": []})";
+
+std::string encode(const CastMessage& message) {
+    std::string frame(message.byteSize(), '\0');
+    char *end = message.serializeTo(&frame[0]);
+    frame.resize(end - frame.data());
+    return frame;
+}
+
+CastMessage testMessage() {
+    CastMessage message;
+    message.set_source_id(ByteView("receiver-0", 10));
+    message.set_destination_id(ByteView("sender-0", 8));
+    message.set_namespace_(ByteView(test_ns, sizeof(test_ns) - 1));
+    message.set_payload_type(CastMessage::STRING);
+    message.set_payload_utf8(
+        ByteView(test_payload, sizeof(test_payload) - 1));
+    return message;
+}
+
+#ifdef CAST_HAVE_PROTOBUF
+bool sameBytes(const std::string& expected, const ByteView& actual) {
+    return expected == std::string(actual.data(), actual.size());
+}
+
+// A valid encoding with random optional fields, then mutated by
+// random byte edits, or replaced by random tag heavy garbage
+std::string randomFrame(std::mt19937_64& random) {
+    auto below = [&random](int n) { return int(random() % n); };
+
+    ProtobufMessage message;
+    message.set_protocol_version(ProtobufMessage::CASTV2_1_0);
+    message.set_source_id(std::string(below(5), 's'));
+    message.set_destination_id("d");
+    message.set_namespace_("urn:x");
+    message.set_payload_type(below(2) ? ProtobufMessage::STRING :
+                             ProtobufMessage::BINARY);
+    if (below(2)) message.set_payload_utf8("hello");
+    if (below(3) == 0) message.set_payload_binary(std::string("\0\1", 2));
+    std::string frame;
+    message.SerializeToString(&frame);
+
+    const int mutations = below(4);
+    for (int i = 0; i < mutations && !frame.empty(); ++i) {
+        switch (below(3)) {
+        case 0:
+            frame[below(frame.size())] = char(random());
+            break;
+        case 1:
+            frame.insert(frame.begin() + below(frame.size() + 1),
+                         char(random()));
+            break;
+        default:
+            frame.erase(frame.begin() + below(frame.size()));
+            break;
+        }
+    }
+
+    if (below(10) == 0) {
+        static const unsigned char tags[] = {
+            0x08, 0x12, 0x1a, 0x22, 0x28, 0x32, 0x3a, 0x0b, 0x0c, 0x1b,
+            0x1c, 0x0d, 0x09, 0x00, 0x80, 0xff, 0x01, 0x02, 0x03, 0x05,
+        };
+        frame.clear();
+        const int length = below(30);
+        for (int i = 0; i < length; ++i) {
+            frame.push_back(below(2) ? char(tags[below(sizeof(tags))]) :
+                            char(random()));
+        }
+    }
+    return frame;
+}
+#endif
+
+}
+
+/* Checks CastMessage against the wire format of
+ * proto/cast_channel.proto.  When protobuf is available, the codec is
+ * compared with protobuf-lite on random and corrupted input.
+ */
+class CastMessageTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void roundTrip();
+    void peekNamespace();
+    void rejectsMissingRequiredFields();
+#ifdef CAST_HAVE_PROTOBUF
+    void decodesLikeProtobuf();
+    void encodesLikeProtobuf();
+    void benchmarkProtobufParse();
+#endif
+    void benchmarkParse();
+};
+
+void CastMessageTest::initTestCase() {
+#if defined(CAST_HAVE_PROTOBUF) && GOOGLE_PROTOBUF_VERSION < 4022000
+    // Don't log every frame protobuf rejects
+    google::protobuf::SetLogHandler(nullptr);
+#endif
+}
+
+void CastMessageTest::roundTrip() {
+    const std::string frame = encode(testMessage());
+    CastMessage decoded;
+    QVERIFY(decoded.parse(frame.data(), frame.size()));
+    QVERIFY(decoded.source_id() == "receiver-0");
+    QVERIFY(decoded.destination_id() == "sender-0");
+    QVERIFY(decoded.namespace_() == test_ns);
+    QCOMPARE(decoded.payload_type(), CastMessage::STRING);
+    QVERIFY(decoded.has_payload_utf8());
+    QVERIFY(decoded.payload_utf8() == test_payload);
+    QVERIFY(!decoded.has_payload_binary());
+    QCOMPARE(decoded.byteSize(), int(frame.size()));
+}
+
+void CastMessageTest::peekNamespace() {
+    const std::string frame = encode(testMessage());
+    ByteView ns;
+    QVERIFY(CastMessage::peekNamespace(frame.data(), frame.size(), ns));
+    QVERIFY(ns == test_ns);
+}
+
+void CastMessageTest::rejectsMissingRequiredFields() {
+    // Everything up to the namespace, leaving out the payload type
+    const std::string frame = encode(testMessage());
+    ByteView ns;
+    QVERIFY(CastMessage::peekNamespace(frame.data(), frame.size(), ns));
+    const int without_payload = ns.data() + ns.size() - frame.data();
+    CastMessage decoded;
+    QVERIFY(!decoded.parse(frame.data(), without_payload));
+    QVERIFY(!decoded.parse(frame.data(), 0));
+}
+
+#ifdef CAST_HAVE_PROTOBUF
+void CastMessageTest::decodesLikeProtobuf() {
+    std::mt19937_64 random(1);
+    for (int i = 0; i < 200000; ++i) {
+        const std::string frame = randomFrame(random);
+        ProtobufMessage expected;
+        const bool expected_ok = expected.ParseFromString(frame);
+        CastMessage actual;
+        const bool actual_ok = actual.parse(frame.data(), frame.size());
+        QCOMPARE(actual_ok, expected_ok);
+        if (!expected_ok) continue;
+
+        QCOMPARE(int(actual.protocol_version()),
+                 int(expected.protocol_version()));
+        QVERIFY(sameBytes(expected.source_id(), actual.source_id()));
+        QVERIFY(sameBytes(expected.destination_id(),
+                          actual.destination_id()));
+        QVERIFY(sameBytes(expected.namespace_(), actual.namespace_()));
+        QCOMPARE(int(actual.payload_type()), int(expected.payload_type()));
+        QCOMPARE(actual.has_payload_utf8(), expected.has_payload_utf8());
+        if (expected.has_payload_utf8()) {
+            QVERIFY(sameBytes(expected.payload_utf8(),
+                              actual.payload_utf8()));
+        }
+        QCOMPARE(actual.has_payload_binary(), expected.has_payload_binary());
+        if (expected.has_payload_binary()) {
+            QVERIFY(sameBytes(expected.payload_binary(),
+                              actual.payload_binary()));
+        }
+    }
+}
+
+void CastMessageTest::encodesLikeProtobuf() {
+    std::mt19937_64 random(2);
+    for (int i = 0; i < 20000; ++i) {
+        ProtobufMessage decoded;
+        if (!decoded.ParseFromString(randomFrame(random))) continue;
+
+        // Re-encode the decoded fields with both codecs
+        ProtobufMessage expected;
+        expected.set_protocol_version(decoded.protocol_version());
+        expected.set_source_id(decoded.source_id());
+        expected.set_destination_id(decoded.destination_id());
+        expected.set_namespace_(decoded.namespace_());
+        expected.set_payload_type(decoded.payload_type());
+        CastMessage actual;
+        actual.set_protocol_version(
+            CastMessage::ProtocolVersion(decoded.protocol_version()));
+        actual.set_source_id(decoded.source_id());
+        actual.set_destination_id(decoded.destination_id());
+        actual.set_namespace_(decoded.namespace_());
+        actual.set_payload_type(
+            CastMessage::PayloadType(decoded.payload_type()));
+        if (decoded.has_payload_utf8()) {
+            expected.set_payload_utf8(decoded.payload_utf8());
+            actual.set_payload_utf8(decoded.payload_utf8());
+        }
+        if (decoded.has_payload_binary()) {
+            expected.set_payload_binary(decoded.payload_binary());
+            actual.set_payload_binary(decoded.payload_binary());
+        }
+
+        std::string expected_frame;
+        expected.SerializeToString(&expected_frame);
+        QCOMPARE(actual.byteSize(), int(expected_frame.size()));
+        QVERIFY(encode(actual) == expected_frame);
+    }
+}
+
+void CastMessageTest::benchmarkProtobufParse() {
+    const std::string frame = encode(testMessage());
+    ProtobufMessage message;
+    QBENCHMARK {
+        message.ParseFromString(frame);
+    }
+}
+#endif
+
+void CastMessageTest::benchmarkParse() {
+    const std::string frame = encode(testMessage());
+    CastMessage message;
+    QBENCHMARK {
+        message.parse(frame.data(), frame.size());
+    }
+}
+
+}
+
+QTEST_GUILESS_MAIN(cast::CastMessageTest)
+
+#include "cast-message-test.moc"
@@ -0,0 +1,204 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "caster-pool.h"
+#include "cast-message.h"
+#include "caster.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QtTest>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cast {
+
+namespace {
+
+// Nothing listens here, so connection attempts fail straight away
+const QString test_host = QStringLiteral("127.0.0.1");
+const int test_port = 1;
+
+const int n_load_devices = 64;
+const int n_load_commands = 4096;
+// Messages decoded by each command in the load test
+const int parses_per_command = 512;
+
+const char test_ns[] = "urn:x-cast:com.google.cast.media";
+const char test_payload[] =
+    R"({"type": "MEDIA_STATUS", "requestId": 42, "status": []})";
+
+std::string mediaStatusFrame() {
+    CastMessage message;
+    message.set_source_id(ByteView("receiver-0", 10));
+    message.set_destination_id(ByteView("sender-0", 8));
+    message.set_namespace_(ByteView(test_ns, sizeof(test_ns) - 1));
+    message.set_payload_type(CastMessage::STRING);
+    message.set_payload_utf8(
+        ByteView(test_payload, sizeof(test_payload) - 1));
+    std::string frame(message.byteSize(), '\0');
+    char *end = message.serializeTo(&frame[0]);
+    frame.resize(end - frame.data());
+    return frame;
+}
+
+}
+
+/* Checks device placement and teardown of CasterPool, and measures
+ * how command throughput scales with the number of worker threads.
+ * The load test spreads CPU bound commands over many devices, so with
+ * enough cores the time should fall close to linearly with the
+ * thread count.
+ */
+class CasterPoolTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void spreadsDevicesOverThreads();
+    void invokeUnknownDevice();
+    void teardownWithQueuedCallbacks();
+    void benchmarkLoad_data();
+    void benchmarkLoad();
+
+private:
+    static std::vector<int> addDevices(CasterPool& pool, int n);
+};
+
+std::vector<int> CasterPoolTest::addDevices(CasterPool& pool, int n) {
+    std::vector<int> ids;
+    for (int i = 0; i < n; ++i) {
+        ids.push_back(pool.addDevice(test_host, test_port));
+    }
+    return ids;
+}
+
+void CasterPoolTest::spreadsDevicesOverThreads() {
+    CasterPool pool;
+    QVERIFY(pool.setProperty("threadCount", 4));
+    const std::vector<int> ids = addDevices(pool, 8);
+    QCOMPARE(pool.property("deviceCount").toInt(), 8);
+
+    QMutex mutex;
+    QHash<QThread*,int> devices_per_thread;
+    QAtomicInt wrong_thread;
+    QSemaphore done;
+    for (int id : ids) {
+        QVERIFY(pool.invoke(id, [&](Caster *caster) {
+                    if (caster->thread() != QThread::currentThread()) {
+                        wrong_thread.ref();
+                    }
+                    QMutexLocker lock(&mutex);
+                    ++devices_per_thread[QThread::currentThread()];
+                    done.release();
+                }));
+    }
+    QVERIFY(done.tryAcquire(int(ids.size()), 5000));
+
+    QCOMPARE(wrong_thread.load(), 0);
+    QCOMPARE(devices_per_thread.size(), 4);
+    QVERIFY(!devices_per_thread.contains(QThread::currentThread()));
+    for (int count : devices_per_thread) {
+        QCOMPARE(count, 2);
+    }
+}
+
+void CasterPoolTest::invokeUnknownDevice() {
+    CasterPool pool;
+    const int id = pool.addDevice(test_host, test_port);
+    pool.removeDevice(id);
+    QCOMPARE(pool.property("deviceCount").toInt(), 0);
+    QVERIFY(!pool.invoke(id, [](Caster*) {}));
+    QVERIFY(!pool.launch(id + 1, QStringLiteral("CC1AD845")));
+}
+
+void CasterPoolTest::teardownWithQueuedCallbacks() {
+    // Commands still queued when the pool is destroyed call back into
+    // it.  Destruction must wait for them without deadlocking.
+    std::unique_ptr<CasterPool> pool(new CasterPool);
+    QVERIFY(pool->setProperty("threadCount", 2));
+    const std::vector<int> ids = addDevices(*pool, 4);
+
+    CasterPool *p = pool.get();
+    QSemaphore started;
+    QAtomicInt finished;
+    for (int id : ids) {
+        QVERIFY(pool->invoke(id, [p, id, &started, &finished](Caster*) {
+                    started.release();
+                    QThread::msleep(50);
+                    p->property("deviceCount").toInt();
+                    p->invoke(id, [](Caster*) {});
+                    finished.ref();
+                }));
+    }
+    started.acquire();
+    pool.reset();
+    QCOMPARE(finished.load(), int(ids.size()));
+}
+
+void CasterPoolTest::benchmarkLoad_data() {
+    QTest::addColumn<int>("threads");
+    for (int threads = 1; threads <= QThread::idealThreadCount();
+         threads *= 2) {
+        QTest::newRow(qPrintable(QStringLiteral("threads=%1").arg(threads)))
+            << threads;
+    }
+}
+
+void CasterPoolTest::benchmarkLoad() {
+    QFETCH(int, threads);
+    CasterPool pool;
+    QVERIFY(pool.setProperty("threadCount", threads));
+    const std::vector<int> ids = addDevices(pool, n_load_devices);
+    const std::string frame = mediaStatusFrame();
+
+    // Issue commands round robin over the devices, each decoding a
+    // batch of messages as the dispatch path would, and time how long
+    // the pool takes to get through them all.
+    QSemaphore done;
+    QAtomicInt failed;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < n_load_commands; ++i) {
+        pool.invoke(ids[i % ids.size()], [&](Caster*) {
+                CastMessage message;
+                for (int j = 0; j < parses_per_command; ++j) {
+                    if (!message.parse(frame.data(), frame.size())) {
+                        failed.ref();
+                    }
+                }
+                done.release();
+            });
+    }
+    QVERIFY(done.tryAcquire(n_load_commands, 60000));
+    const qint64 elapsed = timer.elapsed();
+
+    QCOMPARE(failed.load(), 0);
+    QTest::setBenchmarkResult(elapsed, QTest::WalltimeMilliseconds);
+}
+
+}
+
+QTEST_GUILESS_MAIN(cast::CasterPoolTest)
+
+#include "caster-pool-test.moc"
@@ -0,0 +1,197 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "caster.h"
+#include "cast-message.h"
+#include "channel.h"
+#include "interface.h"
+
+#include <QSignalSpy>
+#include <QtTest>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cast {
+
+namespace {
+
+const QString test_ns = QStringLiteral("urn:x-cast:com.example.routing-test");
+const int n_sessions = 16;
+// Channels opened for the dispatch benchmarks
+const int n_benchmark_channels = 1000;
+
+}
+
+/* Feeds encoded messages through Caster::handleMessage() with many
+ * sender channels connected to two receiver applications, checking
+ * that unicast and broadcast messages only reach the channels they
+ * are addressed to.  The benchmarks time dispatch with a thousand
+ * channels open to one application.
+ */
+class CasterRoutingTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void broadcastReachesEveryChannelToSender();
+    void broadcastSkipsClosedChannels();
+    void unicastReachesOneChannel();
+    void benchmarkUnicastDispatch();
+    void benchmarkBroadcastDispatch();
+
+private:
+    struct Session {
+        Channel *channel;
+        std::unique_ptr<QSignalSpy> spy;
+    };
+
+    void openSessions(const QString& app, std::vector<Session>& sessions);
+    // Encode a message, and decode it again as it would arrive from
+    // the connection
+    static bool decode(const std::string& source,
+                       const std::string& destination, const char *payload,
+                       std::string& frame, CastMessage& message);
+    void deliver(const std::string& source, const std::string& destination,
+                 const char *payload);
+    // Time dispatching a message with n_benchmark_channels open
+    void benchmarkDispatch(const std::string& destination);
+
+    std::unique_ptr<Caster> caster_;
+    std::vector<Session> app_a_;
+    std::vector<Session> app_b_;
+};
+
+void CasterRoutingTest::init() {
+    caster_.reset(new Caster);
+    openSessions(QStringLiteral("app-a"), app_a_);
+    openSessions(QStringLiteral("app-b"), app_b_);
+}
+
+void CasterRoutingTest::cleanup() {
+    app_a_.clear();
+    app_b_.clear();
+    caster_.reset();
+}
+
+void CasterRoutingTest::openSessions(const QString& app,
+                                     std::vector<Session>& sessions) {
+    for (int i = 0; i < n_sessions; ++i) {
+        Channel *channel = caster_->createChannel(
+            QStringLiteral("sender-%1").arg(i), app);
+        Interface *iface = channel->addInterface(test_ns);
+        sessions.push_back(Session{
+                channel,
+                std::unique_ptr<QSignalSpy>(
+                    new QSignalSpy(iface, &Interface::messageReceived))});
+    }
+}
+
+bool CasterRoutingTest::decode(const std::string& source,
+                               const std::string& destination,
+                               const char *payload, std::string& frame,
+                               CastMessage& message) {
+    const std::string ns = test_ns.toStdString();
+    CastMessage encoded;
+    encoded.set_source_id(source);
+    encoded.set_destination_id(destination);
+    encoded.set_namespace_(ns);
+    encoded.set_payload_type(CastMessage::STRING);
+    encoded.set_payload_utf8(ByteView(payload, strlen(payload)));
+
+    frame.assign(encoded.byteSize(), '\0');
+    encoded.serializeTo(&frame[0]);
+    return message.parse(frame.data(), frame.size());
+}
+
+void CasterRoutingTest::deliver(const std::string& source,
+                                const std::string& destination,
+                                const char *payload) {
+    std::string frame;
+    CastMessage decoded;
+    QVERIFY(decode(source, destination, payload, frame, decoded));
+    caster_->handleMessage(decoded);
+}
+
+void CasterRoutingTest::broadcastReachesEveryChannelToSender() {
+    deliver("app-a", "*", R"({"type": "BROADCAST"})");
+
+    for (const auto& session : app_a_) {
+        QCOMPARE(session.spy->count(), 1);
+        QCOMPARE(session.spy->at(0).at(0).toString(),
+                 QStringLiteral(R"({"type": "BROADCAST"})"));
+    }
+    for (const auto& session : app_b_) {
+        QCOMPARE(session.spy->count(), 0);
+    }
+}
+
+void CasterRoutingTest::broadcastSkipsClosedChannels() {
+    app_a_[3].channel->close();
+    deliver("app-a", "*", R"({"type": "BROADCAST"})");
+
+    for (int i = 0; i < n_sessions; ++i) {
+        QCOMPARE(app_a_[i].spy->count(), i == 3 ? 0 : 1);
+        QCOMPARE(app_b_[i].spy->count(), 0);
+    }
+}
+
+void CasterRoutingTest::unicastReachesOneChannel() {
+    deliver("app-b", "sender-5", R"({"type": "UNICAST"})");
+
+    for (int i = 0; i < n_sessions; ++i) {
+        QCOMPARE(app_a_[i].spy->count(), 0);
+        QCOMPARE(app_b_[i].spy->count(), i == 5 ? 1 : 0);
+    }
+}
+
+void CasterRoutingTest::benchmarkDispatch(const std::string& destination) {
+    // A separate caster, without signal spies, so only routing and
+    // the interfaces' own handling are timed
+    Caster caster;
+    for (int i = 0; i < n_benchmark_channels; ++i) {
+        caster.createChannel(QStringLiteral("sender-%1").arg(i),
+                             QStringLiteral("app-c"))
+            ->addInterface(test_ns);
+    }
+    std::string frame;
+    CastMessage message;
+    QVERIFY(decode("app-c", destination, R"({"type": "STATUS"})",
+                   frame, message));
+    QBENCHMARK {
+        caster.handleMessage(message);
+    }
+}
+
+void CasterRoutingTest::benchmarkUnicastDispatch() {
+    benchmarkDispatch("sender-500");
+}
+
+void CasterRoutingTest::benchmarkBroadcastDispatch() {
+    benchmarkDispatch("*");
+}
+
+}
+
+QTEST_GUILESS_MAIN(cast::CasterRoutingTest)
+
+#include "caster-routing-test.moc"
@@ -0,0 +1,161 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "frame-reader.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <QtTest>
+
+namespace cast {
+
+namespace {
+
+void appendFrame(QByteArray& stream, const QByteArray& body) {
+    uchar header[4];
+    qToBigEndian<quint32>(body.size(), header);
+    stream.append(reinterpret_cast<const char*>(header), sizeof(header));
+    stream.append(body);
+}
+
+QByteArray frameBody(int index, int size) {
+    QByteArray body(size, '\0');
+    for (int i = 0; i < size; ++i) {
+        body[i] = char(index + i);
+    }
+    return body;
+}
+
+// Read every frame from the device, as Connection::onReadyRead does
+QList<QByteArray> readAll(FrameReader& reader, QIODevice& device) {
+    QList<QByteArray> frames;
+    const char *data;
+    uint32_t size;
+    while (reader.readFrom(device) > 0) {
+        while (reader.nextFrame(data, size)) {
+            frames.append(QByteArray(data, size));
+        }
+    }
+    return frames;
+}
+
+}
+
+class FrameReaderTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void splitsFrames();
+    void growsForLargeFrames();
+    void skipsOversizedFrames();
+    void benchmarkFramesPerSecond_data();
+    void benchmarkFramesPerSecond();
+};
+
+void FrameReaderTest::splitsFrames() {
+    QByteArray stream;
+    for (int i = 0; i < 200; ++i) {
+        appendFrame(stream, frameBody(i, 1 + i * 7 % 300));
+    }
+    QBuffer device(&stream);
+    device.open(QIODevice::ReadOnly);
+    FrameReader reader(256);
+
+    const QList<QByteArray> frames = readAll(reader, device);
+    QCOMPARE(frames.size(), 200);
+    for (int i = 0; i < frames.size(); ++i) {
+        QCOMPARE(frames[i], frameBody(i, 1 + i * 7 % 300));
+    }
+}
+
+void FrameReaderTest::growsForLargeFrames() {
+    QByteArray stream;
+    appendFrame(stream, frameBody(0, 10000));
+    appendFrame(stream, frameBody(1, 10));
+    QBuffer device(&stream);
+    device.open(QIODevice::ReadOnly);
+    FrameReader reader(4096);
+
+    const QList<QByteArray> frames = readAll(reader, device);
+    QCOMPARE(frames.size(), 2);
+    QCOMPARE(frames[0], frameBody(0, 10000));
+    QCOMPARE(frames[1], frameBody(1, 10));
+    QVERIFY(reader.capacity() >= 10004);
+}
+
+void FrameReaderTest::skipsOversizedFrames() {
+    QByteArray stream;
+    appendFrame(stream, frameBody(0, 5000));
+    appendFrame(stream, frameBody(1, 10));
+    QBuffer device(&stream);
+    device.open(QIODevice::ReadOnly);
+    FrameReader reader(256, 1000);
+
+    const QList<QByteArray> frames = readAll(reader, device);
+    QCOMPARE(frames.size(), 1);
+    QCOMPARE(frames[0], frameBody(1, 10));
+    QCOMPARE(reader.skippedFrames(), quint64(1));
+    QCOMPARE(reader.capacity(), 256);
+}
+
+void FrameReaderTest::benchmarkFramesPerSecond_data() {
+    QTest::addColumn<int>("frame_size");
+    QTest::newRow("64 bytes") << 64;
+    QTest::newRow("512 bytes") << 512;
+    QTest::newRow("4 KiB") << 4096;
+}
+
+void FrameReaderTest::benchmarkFramesPerSecond() {
+    QFETCH(int, frame_size);
+    const int n_frames = 10000;
+    QByteArray stream;
+    for (int i = 0; i < n_frames; ++i) {
+        appendFrame(stream, frameBody(i, frame_size));
+    }
+    QBuffer device(&stream);
+    device.open(QIODevice::ReadOnly);
+    FrameReader reader;
+
+    // Read the stream until a second has passed, and report the rate
+    const char *data;
+    uint32_t size;
+    qint64 frames = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        device.seek(0);
+        reader.clear();
+        while (reader.readFrom(device) > 0) {
+            while (reader.nextFrame(data, size)) {
+                ++frames;
+            }
+        }
+    } while (timer.elapsed() < 1000);
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    QCOMPARE(frames % n_frames, qint64(0));
+    QTest::setBenchmarkResult(frames * 1e9 / elapsed,
+                              QTest::FramesPerSecond);
+}
+
+}
+
+QTEST_GUILESS_MAIN(cast::FrameReaderTest)
+
+#include "frame-reader-test.moc"
@@ -0,0 +1,162 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "json-peek.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest>
+
+namespace cast {
+
+namespace {
+
+// A MEDIA_STATUS broadcast of the size a Cast device sends while
+// playing
+const char media_status[] = R"({
+  "type": "MEDIA_STATUS",
+  "status": [{
+    "mediaSessionId": 1,
+    "playbackRate": 1,
+    "playerState": "PLAYING",
+    "currentTime": 123.456,
+    "supportedMediaCommands": 15,
+    "volume": {"level": 1, "muted": false},
+    "media": {
+      "contentId": "http://example.com/media/video.mp4",
+      "streamType": "BUFFERED",
+      "contentType": "video/mp4",
+      "metadata": {
+        "metadataType": 0,
+        "title": "An example video with \"quotes\" in its title",
+        "subtitle": "Played while benchmarking",
+        "images": [{"url": "http://example.com/media/poster.jpg"}]
+      },
+      "duration": 596.474195
+    },
+    "currentItemId": 1,
+    "items": [{"itemId": 1, "autoplay": true, "customData": {}}],
+    "repeatMode": "REPEAT_OFF"
+  }],
+  "requestId": 0
+})";
+
+}
+
+/* Checks the JSON peek helpers, and compares the cost of peeking at
+ * a MEDIA_STATUS message with fully parsing it.
+ */
+class JsonPeekTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    void peekString_data();
+    void peekString();
+    void peekInt_data();
+    void peekInt();
+    void benchmarkPeekMediaStatus();
+    void benchmarkParseMediaStatus();
+};
+
+void JsonPeekTest::peekString_data() {
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QString>("expected");
+    QTest::newRow("first") << QByteArray(R"({"type": "PING"})")
+                           << QStringLiteral("PING");
+    QTest::newRow("after nested members")
+        << QByteArray(R"({"a": {"type": "X"}, "b": [1, "type"], "type": "PONG"})")
+        << QStringLiteral("PONG");
+    QTest::newRow("missing") << QByteArray(R"({"kind": "PING"})")
+                             << QString();
+    QTest::newRow("not a string") << QByteArray(R"({"type": 1})")
+                                  << QString();
+    QTest::newRow("malformed") << QByteArray(R"({"type" "PING"})")
+                               << QString();
+}
+
+void JsonPeekTest::peekString() {
+    QFETCH(QByteArray, json);
+    QFETCH(QString, expected);
+    const QLatin1String actual =
+        json::peekString(json, QLatin1String("type"));
+    QCOMPARE(QString(actual), expected);
+}
+
+void JsonPeekTest::peekInt_data() {
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<bool>("found");
+    QTest::addColumn<qint64>("expected");
+    QTest::newRow("positive") << QByteArray(R"({"requestId": 42})")
+                              << true << qint64(42);
+    QTest::newRow("negative") << QByteArray(R"({"requestId": -7})")
+                              << true << qint64(-7);
+    QTest::newRow("int max") << QByteArray(R"({"requestId": 2147483647})")
+                             << true << qint64(2147483647);
+    QTest::newRow("above int max")
+        << QByteArray(R"({"requestId": 2147483648})") << false << qint64(0);
+    QTest::newRow("overflows qint64")
+        << QByteArray(R"({"requestId": 99999999999999999999})")
+        << false << qint64(0);
+    QTest::newRow("fraction") << QByteArray(R"({"requestId": 1.5})")
+                              << false << qint64(0);
+    QTest::newRow("missing") << QByteArray(R"({"type": "PING"})")
+                             << false << qint64(0);
+}
+
+void JsonPeekTest::peekInt() {
+    QFETCH(QByteArray, json);
+    QFETCH(bool, found);
+    QFETCH(qint64, expected);
+    qint64 actual = 0;
+    QCOMPARE(json::peekInt(json, QLatin1String("requestId"), actual), found);
+    if (found) {
+        QCOMPARE(actual, expected);
+    }
+}
+
+void JsonPeekTest::benchmarkPeekMediaStatus() {
+    // What MediaInterface reads before deciding to parse a message
+    const QByteArray data(media_status);
+    QBENCHMARK {
+        qint64 request_id = 0;
+        const bool is_status = json::peekString(
+            data, QLatin1String("type")) == QLatin1String("MEDIA_STATUS");
+        json::peekInt(data, QLatin1String("requestId"), request_id);
+        QVERIFY(is_status);
+    }
+}
+
+void JsonPeekTest::benchmarkParseMediaStatus() {
+    // Reading the same members through a full parse
+    const QByteArray data(media_status);
+    QBENCHMARK {
+        const QJsonObject message = QJsonDocument::fromJson(data).object();
+        const bool is_status =
+            message[QStringLiteral("type")].toString() ==
+            QLatin1String("MEDIA_STATUS");
+        const int request_id = message[QStringLiteral("requestId")].toInt();
+        Q_UNUSED(request_id);
+        QVERIFY(is_status);
+    }
+}
+
+}
+
+QTEST_GUILESS_MAIN(cast::JsonPeekTest)
+
+#include "json-peek-test.moc"
@@ -0,0 +1,52 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tls-session-cache.h"
+
+#include <QMutexLocker>
+
+namespace cast {
+
+TlsSessionCache::TlsSessionCache() = default;
+
+TlsSessionCache& TlsSessionCache::instance() {
+    static TlsSessionCache cache;
+    return cache;
+}
+
+QString TlsSessionCache::key(const QString& host_name, int port) {
+    return host_name + QLatin1Char(':') + QString::number(port);
+}
+
+QByteArray TlsSessionCache::ticket(const QString& host_name, int port) const {
+    QMutexLocker lock(&mutex_);
+    return tickets_.value(key(host_name, port));
+}
+
+void TlsSessionCache::setTicket(const QString& host_name, int port,
+                                const QByteArray& ticket) {
+    QMutexLocker lock(&mutex_);
+    tickets_.insert(key(host_name, port), ticket);
+}
+
+void TlsSessionCache::removeTicket(const QString& host_name, int port) {
+    QMutexLocker lock(&mutex_);
+    tickets_.remove(key(host_name, port));
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+namespace cast {
+
+/* A process wide cache of TLS session tickets, keyed on host and
+ * port, used to resume sessions when reconnecting to a device.  It
+ * may be used from any thread.
+ */
+class TlsSessionCache {
+public:
+    static TlsSessionCache& instance();
+
+    QByteArray ticket(const QString& host_name, int port) const;
+    void setTicket(const QString& host_name, int port,
+                   const QByteArray& ticket);
+    void removeTicket(const QString& host_name, int port);
+
+private:
+    TlsSessionCache();
+    static QString key(const QString& host_name, int port);
+
+    mutable QMutex mutex_;
+    QHash<QString,QByteArray> tickets_;
+};
+
+}
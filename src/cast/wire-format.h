@@ -0,0 +1,95 @@
+/*
+ * cast-qml: Chromecast binding for QML
+ * Copyright (C) 2016  James Henstridge
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QByteArray>
+
+#include <cstdint>
+
+namespace cast {
+
+/* Helpers for writing the protocol buffer wire format directly, for
+ * the parts of CastMessage that are encoded on the hot path.
+ */
+namespace wire {
+
+enum class Field : uint32_t {
+    protocol_version = 1,
+    source_id = 2,
+    destination_id = 3,
+    namespace_ = 4,
+    payload_type = 5,
+    payload_utf8 = 6,
+    payload_binary = 7,
+};
+
+enum class WireType : uint32_t {
+    varint = 0,
+    length_delimited = 2,
+};
+
+inline int varintSize(uint64_t value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+inline char *writeVarint(char *out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<char>(value);
+    return out;
+}
+
+inline char *writeTag(char *out, Field field, WireType type) {
+    return writeVarint(
+        out, (static_cast<uint32_t>(field) << 3) | static_cast<uint32_t>(type));
+}
+
+inline int tagSize(Field field) {
+    return varintSize(static_cast<uint32_t>(field) << 3);
+}
+
+inline void appendVarint(QByteArray& out, Field field, uint64_t value) {
+    char buf[20];
+    char *end = writeTag(buf, field, WireType::varint);
+    end = writeVarint(end, value);
+    out.append(buf, end - buf);
+}
+
+inline void appendBytes(QByteArray& out, Field field,
+                        const char *data, int size) {
+    char buf[20];
+    char *end = writeTag(buf, field, WireType::length_delimited);
+    end = writeVarint(end, size);
+    out.append(buf, end - buf);
+    out.append(data, size);
+}
+
+inline void appendBytes(QByteArray& out, Field field, const QByteArray& data) {
+    appendBytes(out, field, data.constData(), data.size());
+}
+
+}
+}